@@ -0,0 +1,20 @@
+# Name:   avr_count.awk
+#
+# Counts instructions per function in avr-gcc -S output. Skips labels,
+# assembler directives and comments. SIZE is passed with -v SIZE=n
+
+/^[A-Za-z_][A-Za-z0-9_]*:/ {
+    fn = substr($1, 1, length($1) - 1)
+    n = 0
+    next
+}
+
+/^\t\.size\t/ {
+    if (fn != "") printf "%-20s %5s %5d\n", fn, SIZE, n
+    fn = ""
+    next
+}
+
+/^\t[a-z]/ {
+    if (fn != "") n++
+}
@@ -0,0 +1,26 @@
+/*
+ *     rbuffer_avr.c
+ *
+ *          Project:  UART for megaAVR, tinyAVR & AVR DA
+ *
+ *          Instantiates every ring buffer variant as out-of-line functions
+ *          so `avr-gcc -S` emits one body per operation. Not linked into
+ *          the firmware; used by `make -C bench avr-count`.
+ */
+
+#include "rbuffer_variants.h"
+
+#ifndef RBUFFER_SIZE
+#define RBUFFER_SIZE 32
+#endif
+
+// 8-bit indices/count can hold at most 128
+#if RBUFFER_SIZE <= 128
+RBUFFER_COUNT_DEFINE(count8, RBUFFER_SIZE, uint8_t, )
+RBUFFER_SPSC_DEFINE(spsc8, RBUFFER_SIZE, uint8_t, )
+RBUFFER_BATCH_DEFINE(batch8, RBUFFER_SIZE, uint8_t, )
+#endif
+
+RBUFFER_COUNT_DEFINE(count16, RBUFFER_SIZE, uint16_t, )
+RBUFFER_SPSC_DEFINE(spsc16, RBUFFER_SIZE, uint16_t, )
+RBUFFER_BATCH_DEFINE(batch16, RBUFFER_SIZE, uint16_t, )
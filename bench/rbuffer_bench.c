@@ -0,0 +1,214 @@
+/*
+ *     rbuffer_bench.c
+ *
+ *          Project:  UART for megaAVR, tinyAVR & AVR DA
+ *
+ *          Native (Linux, gcc) microbenchmark of the ring buffer variants
+ *          in rbuffer_variants.h. Reports ns, cycles (rdtsc) and retired
+ *          instructions (perf counter, when available) per byte moved.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "rbuffer_variants.h"
+
+#define BENCH_BYTES     (1UL << 24)     // Bytes pushed through each ring
+#define BENCH_ROUNDS    5               // Best of N
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// COUNTERS
+static int perf_fd = -1;
+
+static void counter_open(void) {
+    struct perf_event_attr pe;
+    memset(&pe, 0, sizeof(pe));
+    pe.type = PERF_TYPE_HARDWARE;
+    pe.size = sizeof(pe);
+    pe.config = PERF_COUNT_HW_INSTRUCTIONS;
+    pe.disabled = 1;
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    perf_fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+}
+
+static void counter_start(void) {
+    if (perf_fd < 0) return;
+    ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static uint64_t counter_stop(void) {
+    uint64_t n = 0;
+    if (perf_fd < 0) return 0;
+    ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(perf_fd, &n, sizeof(n)) != sizeof(n)) return 0;
+    return n;
+}
+
+static inline uint64_t cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static inline uint64_t nanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// BENCH INSTANCES
+// Producer writes 3/4 of the ring, consumer drains it, so the indices
+// wrap at a different position every pass
+#define CHUNK(SIZE) ((SIZE) - (SIZE) / 4)
+
+#define BENCH_BYTEWISE(NAME, SIZE)                                          \
+static uint32_t NAME##_run(uint32_t total) {                                \
+    static volatile NAME##_t rb;                                            \
+    uint32_t sum = 0, moved = 0;                                            \
+    char c = 0;                                                             \
+    NAME##_init(&rb);                                                       \
+    while (moved < total) {                                                 \
+        for (uint32_t i = 0; i < CHUNK(SIZE) && !NAME##_full(&rb); i++) {   \
+            NAME##_insert(c++, &rb);                                        \
+        }                                                                   \
+        while (!NAME##_empty(&rb)) {                                        \
+            sum += (uint8_t)NAME##_remove(&rb);                             \
+            moved++;                                                        \
+        }                                                                   \
+    }                                                                       \
+    return sum;                                                             \
+}
+
+// All variants are inlined as in uart.c, except OCOUNT which is the count
+// based ring called out-of-line, to show the cost of the call itself
+#define BENCH_COUNT(BITS, SIZE)                                             \
+    RBUFFER_COUNT_DEFINE(count##BITS##_##SIZE, SIZE, uint##BITS##_t,        \
+                         static inline)                                     \
+    BENCH_BYTEWISE(count##BITS##_##SIZE, SIZE)
+
+#define BENCH_OCOUNT(BITS, SIZE)                                            \
+    RBUFFER_COUNT_DEFINE(ocount##BITS##_##SIZE, SIZE, uint##BITS##_t,       \
+                         static __attribute__((noinline)))                  \
+    BENCH_BYTEWISE(ocount##BITS##_##SIZE, SIZE)
+
+#define BENCH_SPSC(BITS, SIZE)                                              \
+    RBUFFER_SPSC_DEFINE(spsc##BITS##_##SIZE, SIZE, uint##BITS##_t,          \
+                        static inline)                                      \
+    BENCH_BYTEWISE(spsc##BITS##_##SIZE, SIZE)
+
+#define BENCH_BATCH(BITS, SIZE)                                             \
+    RBUFFER_BATCH_DEFINE(batch##BITS##_##SIZE, SIZE, uint##BITS##_t,        \
+                         static inline)                                     \
+static uint32_t batch##BITS##_##SIZE##_run(uint32_t total) {                \
+    static batch##BITS##_##SIZE##_t rb;                                     \
+    static char src[SIZE], dst[SIZE];                                       \
+    uint32_t sum = 0, moved = 0;                                            \
+    uint##BITS##_t n;                                                       \
+    batch##BITS##_##SIZE##_init(&rb);                                       \
+    for (uint32_t i = 0; i < (SIZE); i++) src[i] = (char)i;                 \
+    while (moved < total) {                                                 \
+        batch##BITS##_##SIZE##_insert(src, CHUNK(SIZE), &rb);               \
+        n = batch##BITS##_##SIZE##_remove(dst, (SIZE), &rb);                \
+        sum += (uint8_t)dst[0] + (uint8_t)dst[n - 1];                       \
+        moved += n;                                                         \
+        __asm__ volatile("" ::: "memory");                                  \
+    }                                                                       \
+    return sum;                                                             \
+}
+
+// 8-bit indices/count can hold at most 128, 16-bit runs up to 1024
+#define SIZES_8(X, KIND) \
+    X(KIND, 8, 2) X(KIND, 8, 4) X(KIND, 8, 8) X(KIND, 8, 16) \
+    X(KIND, 8, 32) X(KIND, 8, 64) X(KIND, 8, 128)
+#define SIZES_16(X, KIND) \
+    X(KIND, 16, 2) X(KIND, 16, 4) X(KIND, 16, 8) X(KIND, 16, 16) \
+    X(KIND, 16, 32) X(KIND, 16, 64) X(KIND, 16, 128) X(KIND, 16, 256) \
+    X(KIND, 16, 512) X(KIND, 16, 1024)
+#define ALL_VARIANTS(X) \
+    SIZES_8(X, COUNT) SIZES_16(X, COUNT) \
+    SIZES_8(X, OCOUNT) SIZES_16(X, OCOUNT) \
+    SIZES_8(X, SPSC)  SIZES_16(X, SPSC) \
+    SIZES_8(X, BATCH) SIZES_16(X, BATCH)
+
+#define X_DEFINE(KIND, BITS, SIZE) BENCH_##KIND(BITS, SIZE)
+ALL_VARIANTS(X_DEFINE)
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// BENCH TABLE
+typedef struct {
+    const char* kind;
+    uint8_t     bits;
+    uint16_t    size;
+    uint32_t    (*run)(uint32_t total);
+} bench_entry;
+
+#define NAME_COUNT  "count"
+#define NAME_OCOUNT "ocount"
+#define NAME_SPSC   "spsc"
+#define NAME_BATCH  "batch"
+#define FN_COUNT(BITS, SIZE)  count##BITS##_##SIZE##_run
+#define FN_OCOUNT(BITS, SIZE) ocount##BITS##_##SIZE##_run
+#define FN_SPSC(BITS, SIZE)   spsc##BITS##_##SIZE##_run
+#define FN_BATCH(BITS, SIZE)  batch##BITS##_##SIZE##_run
+#define X_ENTRY(KIND, BITS, SIZE) { NAME_##KIND, BITS, SIZE, FN_##KIND(BITS, SIZE) },
+
+static const bench_entry bench_table[] = { ALL_VARIANTS(X_ENTRY) };
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// MAIN
+int main(int argc, char** argv) {
+    uint32_t total = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : BENCH_BYTES;
+    volatile uint32_t sink = 0;
+
+    counter_open();
+
+    printf("# bytes/run: %lu, best of %d, perf counter: %s\n",
+           (unsigned long)total, BENCH_ROUNDS, (perf_fd < 0) ? "unavailable" : "instructions");
+    printf("%-6s %4s %5s %10s %12s %12s\n", "kind", "idx", "size", "ns/byte", "cycles/byte", "instr/byte");
+
+    for (size_t i = 0; i < sizeof(bench_table) / sizeof(bench_table[0]); i++) {
+        const bench_entry* e = &bench_table[i];
+        uint64_t best_ns = UINT64_MAX, best_cyc = UINT64_MAX, best_ins = UINT64_MAX;
+
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            uint64_t t0, c0, ns, cyc, ins;
+            counter_start();
+            t0 = nanos();
+            c0 = cycles();
+            sink += e->run(total);
+            cyc = cycles() - c0;
+            ns = nanos() - t0;
+            ins = counter_stop();
+            if (ns < best_ns) best_ns = ns;
+            if (cyc < best_cyc) best_cyc = cyc;
+            if (ins < best_ins) best_ins = ins;
+        }
+
+        printf("%-6s %4u %5u %10.3f %12.3f ", e->kind, e->bits, e->size,
+               (double)best_ns / total, (double)best_cyc / total);
+        if (perf_fd < 0) {
+            printf("%12s\n", "n/a");
+        }
+        else {
+            printf("%12.3f\n", (double)best_ins / total);
+        }
+    }
+
+    return (sink == 0xFFFFFFFF);
+}
@@ -0,0 +1,127 @@
+/*
+ *     rbuffer_variants.h
+ *
+ *          Project:  UART for megaAVR, tinyAVR & AVR DA
+ *
+ *          Ring buffer variants for benchmarking. Compiles both natively
+ *          (gcc, rbuffer_bench.c) and for AVR (avr-gcc -S, rbuffer_avr.c).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// COUNT BASED RINGBUFFER (SAME AS uart.c)
+// SIZE must be a power of two and fit in IDX_T (max 128 for uint8_t)
+#define RBUFFER_COUNT_DEFINE(NAME, SIZE, IDX_T, ATTR)                       \
+typedef struct {                                                            \
+    volatile char     buffer[SIZE];                                         \
+    volatile IDX_T    in;                                                   \
+    volatile IDX_T    out;                                                  \
+    volatile IDX_T    count;                                                \
+} NAME##_t;                                                                 \
+ATTR void NAME##_init(volatile NAME##_t* rb) {                              \
+    rb->in = 0;                                                             \
+    rb->out = 0;                                                            \
+    rb->count = 0;                                                          \
+}                                                                           \
+ATTR bool NAME##_full(volatile NAME##_t* rb) {                              \
+    return (rb->count == (IDX_T)(SIZE));                                    \
+}                                                                           \
+ATTR bool NAME##_empty(volatile NAME##_t* rb) {                             \
+    return (rb->count == 0);                                                \
+}                                                                           \
+ATTR void NAME##_insert(char data, volatile NAME##_t* rb) {                 \
+    IDX_T in = rb->in;                                                      \
+    rb->buffer[in] = data;                                                  \
+    rb->in = (IDX_T)(in + 1) & ((IDX_T)(SIZE) - 1);                         \
+    rb->count++;                                                            \
+}                                                                           \
+ATTR char NAME##_remove(volatile NAME##_t* rb) {                            \
+    IDX_T out = rb->out;                                                    \
+    char data = rb->buffer[out];                                            \
+    rb->out = (IDX_T)(out + 1) & ((IDX_T)(SIZE) - 1);                       \
+    rb->count--;                                                            \
+    return data;                                                            \
+}
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// INDEX ONLY SPSC RINGBUFFER
+// Free running indices, producer only writes in and consumer only writes
+// out, so no shared count. SIZE must be a power of two and at most half
+// the range of IDX_T (max 128 for uint8_t)
+#define RBUFFER_SPSC_DEFINE(NAME, SIZE, IDX_T, ATTR)                        \
+typedef struct {                                                            \
+    volatile char     buffer[SIZE];                                         \
+    volatile IDX_T    in;                                                   \
+    volatile IDX_T    out;                                                  \
+} NAME##_t;                                                                 \
+ATTR void NAME##_init(volatile NAME##_t* rb) {                              \
+    rb->in = 0;                                                             \
+    rb->out = 0;                                                            \
+}                                                                           \
+ATTR IDX_T NAME##_count(volatile NAME##_t* rb) {                            \
+    return (IDX_T)(rb->in - rb->out);                                       \
+}                                                                           \
+ATTR bool NAME##_full(volatile NAME##_t* rb) {                              \
+    return ((IDX_T)(rb->in - rb->out) == (IDX_T)(SIZE));                    \
+}                                                                           \
+ATTR bool NAME##_empty(volatile NAME##_t* rb) {                             \
+    return (rb->in == rb->out);                                             \
+}                                                                           \
+ATTR void NAME##_insert(char data, volatile NAME##_t* rb) {                 \
+    IDX_T in = rb->in;                                                      \
+    rb->buffer[in & ((IDX_T)(SIZE) - 1)] = data;                            \
+    rb->in = (IDX_T)(in + 1);                                               \
+}                                                                           \
+ATTR char NAME##_remove(volatile NAME##_t* rb) {                            \
+    IDX_T out = rb->out;                                                    \
+    char data = rb->buffer[out & ((IDX_T)(SIZE) - 1)];                      \
+    rb->out = (IDX_T)(out + 1);                                             \
+    return data;                                                            \
+}
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// BATCHED SPSC RINGBUFFER
+// Index only SPSC as above, but moves whole blocks with at most two
+// memcpy per call (split at the wrap point). Returns bytes moved
+#define RBUFFER_BATCH_DEFINE(NAME, SIZE, IDX_T, ATTR)                       \
+typedef struct {                                                            \
+    char              buffer[SIZE];                                         \
+    volatile IDX_T    in;                                                   \
+    volatile IDX_T    out;                                                  \
+} NAME##_t;                                                                 \
+ATTR void NAME##_init(NAME##_t* rb) {                                       \
+    rb->in = 0;                                                             \
+    rb->out = 0;                                                            \
+}                                                                           \
+ATTR IDX_T NAME##_count(NAME##_t* rb) {                                     \
+    return (IDX_T)(rb->in - rb->out);                                       \
+}                                                                           \
+ATTR IDX_T NAME##_insert(const char* data, IDX_T len, NAME##_t* rb) {      \
+    IDX_T in = rb->in;                                                      \
+    IDX_T space = (IDX_T)((IDX_T)(SIZE) - (IDX_T)(in - rb->out));           \
+    IDX_T pos = in & ((IDX_T)(SIZE) - 1);                                   \
+    IDX_T first;                                                            \
+    if (len > space) len = space;                                           \
+    first = (IDX_T)(SIZE) - pos;                                            \
+    if (first > len) first = len;                                           \
+    memcpy(rb->buffer + pos, data, first);                                  \
+    memcpy(rb->buffer, data + first, len - first);                          \
+    rb->in = (IDX_T)(in + len);                                             \
+    return len;                                                             \
+}                                                                           \
+ATTR IDX_T NAME##_remove(char* data, IDX_T len, NAME##_t* rb) {            \
+    IDX_T out = rb->out;                                                    \
+    IDX_T avail = (IDX_T)(rb->in - out);                                    \
+    IDX_T pos = out & ((IDX_T)(SIZE) - 1);                                  \
+    IDX_T first;                                                            \
+    if (len > avail) len = avail;                                           \
+    first = (IDX_T)(SIZE) - pos;                                            \
+    if (first > len) first = len;                                           \
+    memcpy(data, rb->buffer + pos, first);                                  \
+    memcpy(data + first, rb->buffer, len - first);                          \
+    rb->out = (IDX_T)(out + len);                                           \
+    return len;                                                             \
+}
@@ -0,0 +1,49 @@
+# Name:   isr_cycles.awk
+#
+# Sums AVRxt instruction cycles of every interrupt vector in avr-objdump -d
+# output (make isr-cycles). All instructions of a vector are added, branches
+# and skips counted as taken, so the figure is an upper bound of the longest
+# path. Interrupt response (about 10 cycles) is not included
+
+function cycles(op) {
+    if (op in timing) return timing[op]
+    if (op ~ /^br/) return 2                        # Branch taken
+    return 1
+}
+
+BEGIN {
+    split("lds:3 sts:2 ld:2 ldd:2 st:1 std:1 push:1 pop:2 reti:4 ret:4 " \
+          "rjmp:2 jmp:3 rcall:2 call:3 icall:2 ijmp:2 lpm:3 elpm:3 " \
+          "adiw:2 sbiw:2 mul:2 muls:2 mulsu:2 cpse:3 sbrc:3 sbrs:3 sbic:3 sbis:3", t, " ")
+    for (i in t) {
+        split(t[i], kv, ":")
+        timing[kv[1]] = kv[2]
+    }
+}
+
+/^[0-9a-f]+ <__vector_[0-9]+>:/ {
+    if (fn != "") printf "%-14s %5d instr %5d cycles\n", fn, n, c
+    fn = $2
+    gsub(/[<>:]/, "", fn)
+    n = 0
+    c = 0
+    next
+}
+
+/^[0-9a-f]+ <.*>:/ {
+    if (fn != "") printf "%-14s %5d instr %5d cycles\n", fn, n, c
+    fn = ""
+    next
+}
+
+fn != "" && /^ +[0-9a-f]+:\t/ {
+    split($0, f, "\t")
+    split(f[3], w, " ")
+    if (w[1] == "") next
+    n++
+    c += cycles(w[1])
+}
+
+END {
+    if (fn != "") printf "%-14s %5d instr %5d cycles\n", fn, n, c
+}
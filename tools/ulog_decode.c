@@ -0,0 +1,314 @@
+/*
+ *     ulog_decode.c
+ *
+ *          Project:  UART for megaAVR, tinyAVR & AVR DA
+ *
+ *          Host side decoder for ULOG (ulog.h). Reads the format strings
+ *          from the .ulog section of the firmware ELF and rebuilds the text
+ *          from a binary log stream (serial port, pty, capture file or stdin).
+ *
+ *          ulog_decode [-b baud] [-i int_size] firmware.elf [stream]
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define ULOG_MAX_STRING 256
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// ELF (32 or 64 bit, little endian)
+static uint32_t get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t get32(const uint8_t* p) { return get16(p) | (get16(p + 2) << 16); }
+static uint64_t get64(const uint8_t* p) { return get32(p) | ((uint64_t)get32(p + 4) << 32); }
+
+// Returns .ulog contents, or NULL with message
+static uint8_t* elf_ulog_section(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    uint8_t* elf = NULL;
+    uint8_t* section = NULL;
+    long len;
+
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    rewind(f);
+    elf = malloc(len);
+    if (!elf || fread(elf, 1, len, f) != (size_t)len) {
+        fprintf(stderr, "%s: read error\n", path);
+        goto done;
+    }
+    if (len < 52 || memcmp(elf, "\177ELF", 4) != 0 || elf[5] != 1) {
+        fprintf(stderr, "%s: not a little endian ELF file\n", path);
+        goto done;
+    }
+
+    int is64 = (elf[4] == 2);
+    uint64_t shoff = is64 ? get64(elf + 0x28) : get32(elf + 0x20);
+    uint32_t shentsize = get16(elf + (is64 ? 0x3A : 0x2E));
+    uint32_t shnum = get16(elf + (is64 ? 0x3C : 0x30));
+    uint32_t shstrndx = get16(elf + (is64 ? 0x3E : 0x32));
+
+    if (shoff + (uint64_t)shnum * shentsize > (uint64_t)len || shstrndx >= shnum) {
+        fprintf(stderr, "%s: bad section table\n", path);
+        goto done;
+    }
+
+    const uint8_t* strhdr = elf + shoff + shstrndx * shentsize;
+    uint64_t stroff = is64 ? get64(strhdr + 0x18) : get32(strhdr + 0x10);
+
+    for (uint32_t i = 0; i < shnum; i++) {
+        const uint8_t* sh = elf + shoff + i * shentsize;
+        uint64_t name = stroff + get32(sh);
+        uint64_t off = is64 ? get64(sh + 0x18) : get32(sh + 0x10);
+        uint64_t sz = is64 ? get64(sh + 0x20) : get32(sh + 0x14);
+
+        if (name >= (uint64_t)len || strcmp((const char*)elf + name, ".ulog") != 0) {
+            continue;
+        }
+        if (off + sz > (uint64_t)len) {
+            break;
+        }
+        section = malloc(sz + 1);
+        memcpy(section, elf + off, sz);
+        section[sz] = 0;
+        *size = sz;
+        goto done;
+    }
+    fprintf(stderr, "%s: no .ulog section\n", path);
+
+done:
+    free(elf);
+    fclose(f);
+    return section;
+}
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// STREAM
+static int in_fd = 0;
+
+static int next_byte(void) {
+    static uint8_t buf[256];
+    static ssize_t len = 0, pos = 0;
+    if (pos == len) {
+        fflush(stdout);
+        len = read(in_fd, buf, sizeof(buf));
+        pos = 0;
+        if (len <= 0) {
+            return -1;
+        }
+    }
+    return buf[pos++];
+}
+
+static int read_value(int size, uint64_t* value) {
+    *value = 0;
+    for (int i = 0; i < size; i++) {
+        int c = next_byte();
+        if (c < 0) {
+            return -1;
+        }
+        *value |= (uint64_t)c << (8 * i);
+    }
+    return 0;
+}
+
+static speed_t baud_to_speed(long baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return 0;
+    }
+}
+
+static void tty_raw(int fd, long baud) {
+    struct termios t;
+    if (tcgetattr(fd, &t) != 0) {
+        return;                                     // Not a tty, plain file
+    }
+    cfmakeraw(&t);
+    if (baud_to_speed(baud)) {
+        cfsetispeed(&t, baud_to_speed(baud));
+        cfsetospeed(&t, baud_to_speed(baud));
+    }
+    tcsetattr(fd, TCSANOW, &t);
+}
+
+// Sign extends a size byte value to 64 bits
+static int64_t sign_extend(uint64_t v, int size) {
+    if (size < 8 && (v >> (8 * size - 1)) & 1) {
+        v |= ~0ULL << (8 * size);
+    }
+    return (int64_t)v;
+}
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// DECODE ONE RECORD; the format decides the size of each argument as
+// printf varargs on the target (int_size bytes, 4 with 'l', 8 with 'll',
+// 'j' or 'q', float 4)
+#define SPEC_SUFFIX 4                               // "ll" + conversion + NUL
+
+static int decode(const char* fmt, int int_size) {
+    char spec[32];
+    char width[24];
+    uint64_t v;
+
+    while (*fmt) {
+        if (*fmt != '%') {
+            putchar(*fmt++);
+            continue;
+        }
+        if (fmt[1] == '%') {
+            putchar('%');
+            fmt += 2;
+            continue;
+        }
+
+        size_t n = 0;
+        int longs = 0, wide = 0;
+        spec[n++] = *fmt++;
+        while (*fmt && strchr("-+ #0123456789.*", *fmt)) {
+            size_t len = 1;
+            if (*fmt == '*') {                      // Width or precision argument, an int
+                if (read_value(int_size, &v) < 0) return -1;
+                len = (size_t)snprintf(width, sizeof(width), "%lld", (long long)sign_extend(v, int_size));
+            }
+            else {
+                width[0] = *fmt;
+            }
+            fmt++;
+            if (n + len < sizeof(spec) - SPEC_SUFFIX) {   // Drop what does not fit
+                memcpy(spec + n, width, len);
+                n += len;
+            }
+        }
+        while (*fmt && strchr("hlLqjzt", *fmt)) {
+            longs += (*fmt == 'l');
+            wide |= (*fmt == 'j' || *fmt == 'q');   // intmax_t, quad: 8 bytes
+            fmt++;
+        }
+
+        char conv = *fmt ? *fmt++ : 0;
+        int size = wide ? 8 : longs ? 4 * longs : int_size;
+        spec[n] = 0;
+
+        switch (conv) {
+            case 'd': case 'i':
+                if (read_value(size, &v) < 0) return -1;
+                strcat(spec, "lld");
+                printf(spec, (long long)sign_extend(v, size));
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                if (read_value(size, &v) < 0) return -1;
+                strcat(spec, "ll");
+                strncat(spec, &conv, 1);
+                printf(spec, (unsigned long long)v);
+                break;
+            case 'p':
+                if (read_value(int_size, &v) < 0) return -1;
+                printf("0x%0*llx", 2 * int_size, (unsigned long long)v);
+                break;
+            case 'c':
+                if (read_value(int_size, &v) < 0) return -1;
+                strcat(spec, "c");
+                printf(spec, (int)(v & 0xFF));
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                float f;
+                uint32_t raw;
+                if (read_value(4, &v) < 0) return -1;
+                raw = (uint32_t)v;
+                memcpy(&f, &raw, sizeof(f));
+                strncat(spec, &conv, 1);
+                printf(spec, (double)f);
+                break;
+            }
+            case 's': {
+                char str[ULOG_MAX_STRING];
+                size_t len = 0;
+                int c;
+                while ((c = next_byte()) > 0) {
+                    if (len < sizeof(str) - 1) str[len++] = (char)c;
+                }
+                if (c < 0) return -1;
+                str[len] = 0;
+                strcat(spec, "s");
+                printf(spec, str);
+                break;
+            }
+            default:
+                fputs(spec, stdout);                // Unknown, print as is
+                if (conv) putchar(conv);
+                break;
+        }
+    }
+    return 0;
+}
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// MAIN
+int main(int argc, char** argv) {
+    long baud = 9600;
+    int int_size = 2;                               // sizeof(int) on AVR
+    size_t size = 0;
+    uint8_t* formats;
+    int opt, lo, hi;
+
+    while ((opt = getopt(argc, argv, "b:i:")) != -1) {
+        switch (opt) {
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            case 'i': int_size = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-b baud] [-i int_size] firmware.elf [stream]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc || int_size < 1 || int_size > 8) {
+        fprintf(stderr, "usage: %s [-b baud] [-i int_size] firmware.elf [stream]\n", argv[0]);
+        return 2;
+    }
+    if (!(formats = elf_ulog_section(argv[optind], &size))) {
+        return 1;
+    }
+    if (optind + 1 < argc) {
+        in_fd = open(argv[optind + 1], O_RDONLY | O_NOCTTY);
+        if (in_fd < 0) {
+            perror(argv[optind + 1]);
+            return 1;
+        }
+    }
+    tty_raw(in_fd, baud);
+
+    // An ID is valid if it points at the start of a format string,
+    // otherwise drop one byte and try again (resync)
+    lo = next_byte();
+    while (lo >= 0 && (hi = next_byte()) >= 0) {
+        uint32_t id = lo | (hi << 8);
+        if (id >= size || (id > 0 && formats[id - 1] != 0) || formats[id] == 0) {
+            lo = hi;
+            continue;
+        }
+        if (decode((const char*)formats + id, int_size) < 0) {
+            break;
+        }
+        lo = next_byte();
+    }
+
+    fflush(stdout);
+    free(formats);
+    return 0;
+}
@@ -16,10 +16,22 @@
 
 #define USART_RX_ERROR_MASK (USART_BUFOVF_bm | USART_FERR_bm | USART_PERR_bm) // [Datasheet ss. 295]
 
+#ifdef USART_ONEWIRE_ENABLE
+// One-wire timeout tick of 100 us: _delay_loop_2() takes 4 cycles per count,
+// the polling loop around it about USART_ONEWIRE_LOOP_CYCLES (estimated)
+#define USART_ONEWIRE_LOOP_CYCLES 25
+#define USART_ONEWIRE_TICK ((uint16_t)((F_CPU / 10000UL - USART_ONEWIRE_LOOP_CYCLES) / 4))
+#endif
+
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // RINGBUFFER STRUCT
 typedef struct { 
+#ifdef RBUFFER_POOL
+    volatile char*    buffer;                   // Claimed from rbuffer_pool, NULL if closed
+    uint8_t           mask;                     // Size - 1
+#else
     volatile char     buffer[RBUFFER_SIZE];     
+#endif
     volatile uint8_t  in;                           
     volatile uint8_t  out;                          
     volatile uint8_t  count;         
@@ -27,79 +39,365 @@ typedef struct {
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // RINGBUFFER FUNCTIONS
-void rbuffer_init(volatile ringbuffer* rb) {
+// Always inlined, so an ISR only saves the few registers it actually uses
+#define RBUFFER_INLINE static inline __attribute__((always_inline))
+
+#ifdef RBUFFER_POOL
+#define RBUFFER_MASK(rb) ((rb)->mask)
+#else
+#define RBUFFER_MASK(rb) ((uint8_t)RBUFFER_SIZE - 1)
+#endif
+
+RBUFFER_INLINE void rbuffer_init(volatile ringbuffer* rb) {
 	rb->in = 0;
 	rb->out = 0;
 	rb->count = 0;
 }
 
-uint8_t rbuffer_count(volatile ringbuffer* rb) {
+RBUFFER_INLINE uint8_t rbuffer_count(volatile ringbuffer* rb) {
 	return rb->count;
 }
 
-bool rbuffer_full(volatile ringbuffer* rb) {
-	return (rb->count == (uint8_t)RBUFFER_SIZE);
+RBUFFER_INLINE bool rbuffer_full(volatile ringbuffer* rb) {
+	return (rb->count == (uint8_t)(RBUFFER_MASK(rb) + 1));
 }
 
-bool rbuffer_empty(volatile ringbuffer* rb) {
+RBUFFER_INLINE bool rbuffer_empty(volatile ringbuffer* rb) {
 	return (rb->count == 0);
 }
 
-void rbuffer_insert(char data, volatile ringbuffer* rb) {   
-	*(rb->buffer + rb->in) = data;
-	rb->in = (rb->in + 1) & ((uint8_t)RBUFFER_SIZE - 1);
+RBUFFER_INLINE void rbuffer_insert(char data, volatile ringbuffer* rb) {   
+	uint8_t in = rb->in;							// Read volatile index once
+	rb->buffer[in] = data;
+	rb->in = (in + 1) & RBUFFER_MASK(rb);
 	rb->count++;
 }
 
-char rbuffer_remove(volatile ringbuffer* rb) {
-	char data = *(rb->buffer + rb->out);
-	rb->out = (rb->out + 1) & ((uint8_t)RBUFFER_SIZE - 1);
+RBUFFER_INLINE char rbuffer_remove(volatile ringbuffer* rb) {
+	uint8_t out = rb->out;							// Read volatile index once
+	char data = rb->buffer[out];
+	rb->out = (out + 1) & RBUFFER_MASK(rb);
 	rb->count--;
 	return data;
 }
 
+#if defined(USART_ISR_NAKED) && defined(RBUFFER_POOL)
+#error "USART_ISR_NAKED needs the fixed size ring buffers, disable RBUFFER_POOL"
+#endif
+
+#if defined(USART_ISR_NAKED) && defined(USART_ONEWIRE_ENABLE)
+#error "USART_ISR_NAKED does not discard one-wire echo, disable USART_ONEWIRE_ENABLE"
+#endif
+
+#if defined(USART_ISR_NAKED) && defined(USART_MSPI_ENABLE)
+#error "USART_ISR_NAKED does not track MSPI Tx for block transfers, disable USART_MSPI_ENABLE"
+#endif
+
+#ifdef USART_ISR_NAKED
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// HAND TUNED ISR BODIES (ISR_NAKED)
+// Same function as the C ISRs below. Saves SREG, r24, r25 and Z only.
+// Cycles for AVRxt incl. prologue and reti (see README, Cycle budget):
+//   RXC  47
+//   DRE  44 (data sent), 35 (buffer empty, DREIE cleared)
+// Relies on -fpack-struct ringbuffer layout and RBUFFER_SIZE <= 128
+#define USART_RXC_NAKED(USARTN, RB, ERR)								\
+	__asm__ __volatile__(												\
+		"push r24"							"\n\t"						\
+		"in   r24, __SREG__"				"\n\t"						\
+		"push r24"							"\n\t"						\
+		"push r25"							"\n\t"						\
+		"push r30"							"\n\t"						\
+		"push r31"							"\n\t"						\
+		"lds  r25, %[in]"					"\n\t"	/* Z = buffer + in */	\
+		"mov  r30, r25"						"\n\t"						\
+		"ldi  r31, 0"						"\n\t"						\
+		"subi r30, lo8(-(%[buf]))"			"\n\t"						\
+		"sbci r31, hi8(-(%[buf]))"			"\n\t"						\
+		"lds  r24, %[rxl]"					"\n\t"	/* buffer[in] = RXDATAL */	\
+		"st   Z, r24"						"\n\t"						\
+		"inc  r25"							"\n\t"	/* in = (in + 1) & mask */	\
+		"andi r25, %[mask]"					"\n\t"						\
+		"sts  %[in], r25"					"\n\t"						\
+		"lds  r24, %[cnt]"					"\n\t"	/* count++ */			\
+		"inc  r24"							"\n\t"						\
+		"sts  %[cnt], r24"					"\n\t"						\
+		"lds  r24, %[rxh]"					"\n\t"	/* error = RXDATAH */	\
+		"sts  %[err], r24"					"\n\t"						\
+		"pop  r31"							"\n\t"						\
+		"pop  r30"							"\n\t"						\
+		"pop  r25"							"\n\t"						\
+		"pop  r24"							"\n\t"						\
+		"out  __SREG__, r24"				"\n\t"						\
+		"pop  r24"							"\n\t"						\
+		"reti"															\
+		:																\
+		: [buf]  "i" (&RB.buffer[0]),									\
+		  [in]   "i" (&RB.in),											\
+		  [cnt]  "i" (&RB.count),										\
+		  [err]  "i" (&ERR),											\
+		  [rxl]  "n" (_SFR_MEM_ADDR(USARTN.RXDATAL)),					\
+		  [rxh]  "n" (_SFR_MEM_ADDR(USARTN.RXDATAH)),					\
+		  [mask] "M" (RBUFFER_SIZE - 1))
+
+#define USART_DRE_NAKED(USARTN, RB)										\
+	__asm__ __volatile__(												\
+		"push r24"							"\n\t"						\
+		"in   r24, __SREG__"				"\n\t"						\
+		"push r24"							"\n\t"						\
+		"push r25"							"\n\t"						\
+		"push r30"							"\n\t"						\
+		"push r31"							"\n\t"						\
+		"lds  r24, %[cnt]"					"\n\t"	/* Empty? */			\
+		"tst  r24"							"\n\t"						\
+		"breq 2f"							"\n\t"						\
+		"lds  r25, %[out]"					"\n\t"	/* Z = buffer + out */	\
+		"mov  r30, r25"						"\n\t"						\
+		"ldi  r31, 0"						"\n\t"						\
+		"subi r30, lo8(-(%[buf]))"			"\n\t"						\
+		"sbci r31, hi8(-(%[buf]))"			"\n\t"						\
+		"ld   r30, Z"						"\n\t"	/* TXDATAL = buffer[out] */	\
+		"sts  %[txl], r30"					"\n\t"						\
+		"inc  r25"							"\n\t"	/* out = (out + 1) & mask */	\
+		"andi r25, %[mask]"					"\n\t"						\
+		"sts  %[out], r25"					"\n\t"						\
+		"dec  r24"							"\n\t"	/* count-- */			\
+		"sts  %[cnt], r24"					"\n\t"						\
+		"1:"								"\n\t"						\
+		"pop  r31"							"\n\t"						\
+		"pop  r30"							"\n\t"						\
+		"pop  r25"							"\n\t"						\
+		"pop  r24"							"\n\t"						\
+		"out  __SREG__, r24"				"\n\t"						\
+		"pop  r24"							"\n\t"						\
+		"reti"								"\n\t"						\
+		"2:"								"\n\t"						\
+		"lds  r24, %[ctrla]"				"\n\t"	/* Disable Tx interrupt */	\
+		"andi r24, %[dreie]"				"\n\t"						\
+		"sts  %[ctrla], r24"				"\n\t"						\
+		"rjmp 1b"														\
+		:																\
+		: [buf]   "i" (&RB.buffer[0]),									\
+		  [out]   "i" (&RB.out),										\
+		  [cnt]   "i" (&RB.count),										\
+		  [txl]   "n" (_SFR_MEM_ADDR(USARTN.TXDATAL)),					\
+		  [ctrla] "n" (_SFR_MEM_ADDR(USARTN.CTRLA)),					\
+		  [dreie] "M" ((uint8_t)~USART_DREIE_bm),						\
+		  [mask]  "M" (RBUFFER_SIZE - 1))
+#endif
+
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // RINGBUFFERS & VARIABLES
 #ifdef USART0_ENABLE
 volatile ringbuffer rb_rx0;		// Receive 
 volatile ringbuffer rb_tx0;		// Transmit
 volatile uint8_t usart0_error;	// Holds error from RXDATAH
+#ifdef USART_ONEWIRE_ENABLE
+volatile uint8_t usart0_echo;	// One-wire bytes sent, not yet echoed
+#endif
+#ifdef USART_MSPI_ENABLE
+volatile bool usart0_mspi_busy;	// Interrupt driven Tx since last block transfer
+#endif
 #endif
 
 #ifdef USART1_ENABLE
 volatile ringbuffer rb_rx1;		// Receive 
 volatile ringbuffer rb_tx1;		// Transmit
 volatile uint8_t usart1_error;	// Holds error from RXDATAH
+#ifdef USART_ONEWIRE_ENABLE
+volatile uint8_t usart1_echo;	// One-wire bytes sent, not yet echoed
+#endif
+#ifdef USART_MSPI_ENABLE
+volatile bool usart1_mspi_busy;	// Interrupt driven Tx since last block transfer
+#endif
 #endif
 
 #ifdef USART2_ENABLE
 volatile ringbuffer rb_rx2;		// Receive 
 volatile ringbuffer rb_tx2;		// Transmit
 volatile uint8_t usart2_error;	// Holds error from RXDATAH
+#ifdef USART_ONEWIRE_ENABLE
+volatile uint8_t usart2_echo;	// One-wire bytes sent, not yet echoed
+#endif
+#ifdef USART_MSPI_ENABLE
+volatile bool usart2_mspi_busy;	// Interrupt driven Tx since last block transfer
+#endif
 #endif
 
 #ifdef USART3_ENABLE
 volatile ringbuffer rb_rx3;		// Receive 
 volatile ringbuffer rb_tx3;		// Transmit
 volatile uint8_t usart3_error;	// Holds error from RXDATAH
+#ifdef USART_ONEWIRE_ENABLE
+volatile uint8_t usart3_echo;	// One-wire bytes sent, not yet echoed
+#endif
+#ifdef USART_MSPI_ENABLE
+volatile bool usart3_mspi_busy;	// Interrupt driven Tx since last block transfer
+#endif
 #endif
 
 #ifdef USART4_ENABLE
 volatile ringbuffer rb_rx4;		// Receive 
 volatile ringbuffer rb_tx4;		// Transmit
 volatile uint8_t usart4_error;	// Holds error from RXDATAH
+#ifdef USART_ONEWIRE_ENABLE
+volatile uint8_t usart4_echo;	// One-wire bytes sent, not yet echoed
+#endif
+#ifdef USART_MSPI_ENABLE
+volatile bool usart4_mspi_busy;	// Interrupt driven Tx since last block transfer
+#endif
 #endif
 
 #ifdef USART5_ENABLE
 volatile ringbuffer rb_rx5;		// Receive 
 volatile ringbuffer rb_tx5;		// Transmit
 volatile uint8_t usart5_error;	// Holds error from RXDATAH
+#ifdef USART_ONEWIRE_ENABLE
+volatile uint8_t usart5_echo;	// One-wire bytes sent, not yet echoed
+#endif
+#ifdef USART_MSPI_ENABLE
+volatile bool usart5_mspi_busy;	// Interrupt driven Tx since last block transfer
+#endif
+#endif
+
+#ifdef RBUFFER_POOL
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// RINGBUFFER POOL
+// Ring buffer storage is claimed by usartN_init and released by usartN_close.
+// The rings themselves are the allocation table; a free gap starts at offset
+// 0 or at the end of a claimed block, and the best fitting gap is used
+static char rbuffer_pool[RBUFFER_POOL_SIZE];
+
+static volatile ringbuffer* const rbuffer_pool_rings[] = {
+#ifdef USART0_ENABLE
+	&rb_rx0, &rb_tx0,
+#endif
+#ifdef USART1_ENABLE
+	&rb_rx1, &rb_tx1,
+#endif
+#ifdef USART2_ENABLE
+	&rb_rx2, &rb_tx2,
+#endif
+#ifdef USART3_ENABLE
+	&rb_rx3, &rb_tx3,
+#endif
+#ifdef USART4_ENABLE
+	&rb_rx4, &rb_tx4,
+#endif
+#ifdef USART5_ENABLE
+	&rb_rx5, &rb_tx5,
+#endif
+};
+
+#define RBUFFER_POOL_RINGS (sizeof(rbuffer_pool_rings) / sizeof(rbuffer_pool_rings[0]))
+
+// Size of the free gap starting at offset, 0 if offset is inside a claimed block
+static uint16_t rbuffer_pool_gap(uint16_t offset) {
+	uint16_t end = RBUFFER_POOL_SIZE;
+	for (uint8_t i = 0; i < RBUFFER_POOL_RINGS; i++) {
+		volatile ringbuffer* rb = rbuffer_pool_rings[i];
+		if (rb->buffer == NULL) {
+			continue;
+		}
+		uint16_t start = rb->buffer - rbuffer_pool;
+		if (offset >= start && offset < start + rb->mask + 1) {
+			return 0;
+		}
+		if (start >= offset && start < end) {
+			end = start;
+		}
+	}
+	return end - offset;
+}
+
+// Finds the best fitting gap for size (or the largest gap if size is 0). 
+// Returns the gap size and sets *offset, 0 if nothing fits
+static uint16_t rbuffer_pool_fit(uint16_t size, uint16_t* offset) {
+	uint16_t best = 0;
+	for (uint8_t i = 0; i <= RBUFFER_POOL_RINGS; i++) {
+		uint16_t candidate = 0;
+		if (i < RBUFFER_POOL_RINGS) {
+			volatile ringbuffer* rb = rbuffer_pool_rings[i];
+			if (rb->buffer == NULL) {
+				continue;
+			}
+			candidate = (rb->buffer - rbuffer_pool) + rb->mask + 1;
+		}
+		uint16_t gap = rbuffer_pool_gap(candidate);
+		if (gap == 0 || gap < size) {
+			continue;
+		}
+		if (best == 0 || (size ? (gap < best) : (gap > best))) {
+			best = gap;
+			*offset = candidate;
+		}
+	}
+	return best;
+}
+
+static void rbuffer_pool_release(volatile ringbuffer* rb) {
+	rb->buffer = NULL;
+	rb->mask = 0;
+	rbuffer_init(rb);
+}
+
+// Claims Rx and Tx storage together, size must be 2, 4, 8, 16, 32, 64 or 128
+static bool rbuffer_pool_claim(volatile ringbuffer* rx, uint8_t rx_size, volatile ringbuffer* tx, uint8_t tx_size) {
+	uint16_t offset;
+	rbuffer_pool_release(rx);
+	rbuffer_pool_release(tx);
+	if (rx_size < 2 || rx_size > 128 || (rx_size & (rx_size - 1)) ||
+		tx_size < 2 || tx_size > 128 || (tx_size & (tx_size - 1))) {
+		return false;
+	}
+	if (!rbuffer_pool_fit(rx_size, &offset)) {
+		return false;
+	}
+	rx->buffer = rbuffer_pool + offset;
+	rx->mask = rx_size - 1;
+	if (!rbuffer_pool_fit(tx_size, &offset)) {
+		rbuffer_pool_release(rx);
+		return false;
+	}
+	tx->buffer = rbuffer_pool + offset;
+	tx->mask = tx_size - 1;
+	return true;
+}
+
+uint16_t usart_pool_free(void) {
+	uint16_t bytes = RBUFFER_POOL_SIZE;
+	for (uint8_t i = 0; i < RBUFFER_POOL_RINGS; i++) {
+		if (rbuffer_pool_rings[i]->buffer != NULL) {
+			bytes -= rbuffer_pool_rings[i]->mask + 1;
+		}
+	}
+	return bytes;
+}
+
+uint16_t usart_pool_largest(void) {
+	uint16_t offset;
+	return rbuffer_pool_fit(0, &offset);
+}
+
+// 0% when all free bytes are in one block, towards 100% when scattered
+uint8_t usart_pool_fragmentation(void) {
+	uint16_t bytes = usart_pool_free();
+	if (bytes == 0) {
+		return 0;
+	}
+	return 100 - (uint8_t)(((uint32_t)usart_pool_largest() * 100) / bytes);
+}
 #endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART0 FUNCTIONS
 #ifdef USART0_ENABLE
 void usart0_send_char(char c) {
+#ifdef RBUFFER_POOL
+	if (rb_tx0.buffer == NULL) {
+		return;										// Unit closed or pool exhausted, drop
+	}
+#endif
 	while(rbuffer_full(&rb_tx0));
 	rbuffer_insert(c, &rb_tx0);
 	USART0.CTRLA |= USART_DREIE_bm;					// Enable Tx interrupt 
@@ -113,14 +411,35 @@ int usart0_print_char(char c, FILE *stream) {
 FILE USART0_stream = FDEV_SETUP_STREAM(usart0_print_char, NULL, _FDEV_SETUP_WRITE);
 
 void usart0_init(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx0.buffer == NULL && !rbuffer_pool_claim(&rb_rx0, RBUFFER_SIZE, &rb_tx0, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
 	rbuffer_init(&rb_rx0);							// Init RX0 buffer
 	rbuffer_init(&rb_tx0);							// Init TX0 buffer
+#ifdef USART_ONEWIRE_ENABLE
+	usart0_echo = 0;
+#endif
 	usart0_port_init();								// Defined in uart_settings.h
     USART0.BAUD = baud_rate; 						// Set BAUD rate
 	USART0.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
 	USART0.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
 }
 
+#ifdef RBUFFER_POOL
+bool usart0_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size) {
+	if (USART0.CTRLB & (USART_RXEN_bm | USART_TXEN_bm)) {
+		usart0_close();								// Open unit, finish Tx before rings are released
+	}
+	if (!rbuffer_pool_claim(&rb_rx0, rx_size, &rb_tx0, tx_size)) {
+		return false;								// Pool exhausted, unit stays closed
+	}
+	usart0_init(baud_rate);
+	return true;
+}
+#endif
+
 void usart0_send_string(char* str, uint8_t len) {
 	for (size_t i=0; i<len; i++) {
 		usart0_send_char(str[i]);
@@ -148,13 +467,160 @@ void usart0_close(void) {
 
 	USART0.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt
 	USART0.CTRLA &= ~USART_DREIE_bm;				// Disable Tx interrupt
+
+#ifdef USART_MSPI_ENABLE
+	USART0.CTRLC = USART_CHSIZE_8BIT_gc;			// Back to asynchronous 8N1 (reset value)
+	usart0_mspi_busy = false;
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+	USART0.CTRLA &= ~USART_LBME_bm;				// Disable loop-back
+	USART0.CTRLB &= ~USART_ODME_bm;				// Disable open-drain
+	usart0_echo = 0;								// Echo of last bytes never arrives
+#endif
+
+#ifdef RBUFFER_POOL
+	rbuffer_pool_release(&rb_rx0);					// Return ring buffers to pool
+	rbuffer_pool_release(&rb_tx0);
+#endif
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart0_init_mspi(uint16_t baud_rate, uint8_t mode) {
+#ifdef RBUFFER_POOL
+	if (rb_rx0.buffer == NULL && !rbuffer_pool_claim(&rb_rx0, RBUFFER_SIZE, &rb_tx0, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx0);							// Init RX0 buffer
+	rbuffer_init(&rb_tx0);							// Init TX0 buffer
+	usart0_mspi_busy = false;
+	usart0_mspi_port_init();						// Defined in uart_settings.h
+	USART0.BAUD = baud_rate;						// Set SCK rate, use MSPI_BAUD_RATE()
+	USART0.CTRLC = USART_CMODE_MSPI_gc | mode;		// Master SPI, phase & bit order
+	USART0.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART0.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Full duplex block fast path; tx NULL sends 0xFF, rx NULL discards. Polls
+// DREIF/RXCIF with the Rx interrupt off, instead of two interrupts per byte.
+// At most 2 bytes in flight, so the 2 byte Rx FIFO can never overflow
+void usart0_mspi_transfer(const char* tx, char* rx, uint16_t len) {
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	char c;
+
+	if (!(USART0.CTRLB & USART_TXEN_bm) || (USART0.CTRLC & USART_CMODE_gm) != USART_CMODE_MSPI_gc) {
+		return;										// Unit closed or not in MSPI mode
+	}
+	while(!rbuffer_empty(&rb_tx0)); 				// Let interrupt driven Tx finish
+	USART0.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt, poll instead
+	if (usart0_mspi_busy) {
+		while(!(USART0.STATUS & USART_TXCIF_bm));		// Last byte from Tx ISR clocked out
+		usart0_mspi_busy = false;
+	}
+	while (USART0.STATUS & USART_RXCIF_bm) {			// Its Rx bytes still belong to rb_rx0
+		c = USART0.RXDATAL;
+		if (!rbuffer_full(&rb_rx0)) {
+			rbuffer_insert(c, &rb_rx0);
+		}
+	}
+
+	while (received < len) {
+		if (sent < len && (uint16_t)(sent - received) < 2 && (USART0.STATUS & USART_DREIF_bm)) {
+			USART0.TXDATAL = tx ? tx[sent] : (char)0xFF;
+			sent++;
+		}
+		if (USART0.STATUS & USART_RXCIF_bm) {
+			c = USART0.RXDATAL;
+			if (rx) {
+				rx[received] = c;
+			}
+			received++;
+		}
+	}
+
+	USART0.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+uint8_t usart0_mspi_exchange(uint8_t data) {
+	char c = (char)data;
+	usart0_mspi_transfer(&c, &c, 1);
+	return (uint8_t)c;
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart0_init_onewire(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx0.buffer == NULL && !rbuffer_pool_claim(&rb_rx0, RBUFFER_SIZE, &rb_tx0, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx0);							// Init RX0 buffer
+	rbuffer_init(&rb_tx0);							// Init TX0 buffer
+	usart0_echo = 0;
+	usart0_onewire_port_init();						// Defined in uart_settings.h
+    USART0.BAUD = baud_rate; 						// Set BAUD rate
+	USART0.CTRLA |= USART_LBME_bm;					// Loop-back, TxD drives the receiver
+	USART0.CTRLB |= USART_ODME_bm;					// Open-drain TxD
+	USART0.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART0.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Sends request and collects up to rx_len reply bytes. Rx starts when the
+// last request byte has echoed back, i.e. the bus is released. timeout_ms
+// covers both the echo and the reply. Returns number of reply bytes, fewer
+// than rx_len on timeout and 0 if an echo was lost
+uint8_t usart0_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms) {
+	uint32_t timeout = (uint32_t)timeout_ms * 10;	// 100 us ticks
+	uint8_t received = 0;
+
+	if (!(USART0.CTRLB & USART_TXEN_bm)) {
+		return 0;									// Unit closed (or pool exhausted)
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rbuffer_init(&rb_rx0);						// Drop stale input
+	}
+	usart0_send_string((char*)tx, tx_len);
+	while(!rbuffer_empty(&rb_tx0) || usart0_echo) {	// Wait for own bytes to echo back
+		if (!timeout) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rbuffer_init(&rb_tx0);				// Echo lost, drop rest of request
+				usart0_echo = 0;
+			}
+			return 0;
+		}
+		_delay_loop_2(USART_ONEWIRE_TICK);
+		timeout--;
+	}
+
+	while (received < rx_len && timeout) {
+		if (!rbuffer_empty(&rb_rx0)) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rx[received] = rbuffer_remove(&rb_rx0);
+			}
+			received++;
+		}
+		else {
+			_delay_loop_2(USART_ONEWIRE_TICK);
+			timeout--;
+		}
+	}
+	return received;
+}
+#endif
 #endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART1 FUNCTIONS
 #ifdef USART1_ENABLE
 void usart1_send_char(char c) {
+#ifdef RBUFFER_POOL
+	if (rb_tx1.buffer == NULL) {
+		return;										// Unit closed or pool exhausted, drop
+	}
+#endif
 	while(rbuffer_full(&rb_tx1));
 	rbuffer_insert(c, &rb_tx1);
 	USART1.CTRLA |= USART_DREIE_bm;					// Enable Tx interrupt
@@ -168,14 +634,35 @@ int usart1_print_char(char c, FILE *stream) {
 FILE USART1_stream = FDEV_SETUP_STREAM(usart1_print_char, NULL, _FDEV_SETUP_WRITE);
 
 void usart1_init(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx1.buffer == NULL && !rbuffer_pool_claim(&rb_rx1, RBUFFER_SIZE, &rb_tx1, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
 	rbuffer_init(&rb_rx1);							// Init RX1 buffer
 	rbuffer_init(&rb_tx1);							// Init TX1 buffer
+#ifdef USART_ONEWIRE_ENABLE
+	usart1_echo = 0;
+#endif
 	usart1_port_init();								// Defined in uart_settings.h
     USART1.BAUD = baud_rate; 						// Set BAUD rate
 	USART1.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
 	USART1.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
 }
 
+#ifdef RBUFFER_POOL
+bool usart1_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size) {
+	if (USART1.CTRLB & (USART_RXEN_bm | USART_TXEN_bm)) {
+		usart1_close();								// Open unit, finish Tx before rings are released
+	}
+	if (!rbuffer_pool_claim(&rb_rx1, rx_size, &rb_tx1, tx_size)) {
+		return false;								// Pool exhausted, unit stays closed
+	}
+	usart1_init(baud_rate);
+	return true;
+}
+#endif
+
 void usart1_send_string(char* str, uint8_t len) {
 	for (size_t i=0; i<len; i++) {
 		usart1_send_char(str[i]);
@@ -203,13 +690,160 @@ void usart1_close(void) {
 
 	USART1.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt
 	USART1.CTRLA &= ~USART_DREIE_bm;				// Disable Tx interrupt
+
+#ifdef USART_MSPI_ENABLE
+	USART1.CTRLC = USART_CHSIZE_8BIT_gc;			// Back to asynchronous 8N1 (reset value)
+	usart1_mspi_busy = false;
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+	USART1.CTRLA &= ~USART_LBME_bm;				// Disable loop-back
+	USART1.CTRLB &= ~USART_ODME_bm;				// Disable open-drain
+	usart1_echo = 0;								// Echo of last bytes never arrives
+#endif
+
+#ifdef RBUFFER_POOL
+	rbuffer_pool_release(&rb_rx1);					// Return ring buffers to pool
+	rbuffer_pool_release(&rb_tx1);
+#endif
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart1_init_mspi(uint16_t baud_rate, uint8_t mode) {
+#ifdef RBUFFER_POOL
+	if (rb_rx1.buffer == NULL && !rbuffer_pool_claim(&rb_rx1, RBUFFER_SIZE, &rb_tx1, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx1);							// Init RX1 buffer
+	rbuffer_init(&rb_tx1);							// Init TX1 buffer
+	usart1_mspi_busy = false;
+	usart1_mspi_port_init();						// Defined in uart_settings.h
+	USART1.BAUD = baud_rate;						// Set SCK rate, use MSPI_BAUD_RATE()
+	USART1.CTRLC = USART_CMODE_MSPI_gc | mode;		// Master SPI, phase & bit order
+	USART1.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART1.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Full duplex block fast path; tx NULL sends 0xFF, rx NULL discards. Polls
+// DREIF/RXCIF with the Rx interrupt off, instead of two interrupts per byte.
+// At most 2 bytes in flight, so the 2 byte Rx FIFO can never overflow
+void usart1_mspi_transfer(const char* tx, char* rx, uint16_t len) {
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	char c;
+
+	if (!(USART1.CTRLB & USART_TXEN_bm) || (USART1.CTRLC & USART_CMODE_gm) != USART_CMODE_MSPI_gc) {
+		return;										// Unit closed or not in MSPI mode
+	}
+	while(!rbuffer_empty(&rb_tx1)); 				// Let interrupt driven Tx finish
+	USART1.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt, poll instead
+	if (usart1_mspi_busy) {
+		while(!(USART1.STATUS & USART_TXCIF_bm));		// Last byte from Tx ISR clocked out
+		usart1_mspi_busy = false;
+	}
+	while (USART1.STATUS & USART_RXCIF_bm) {			// Its Rx bytes still belong to rb_rx1
+		c = USART1.RXDATAL;
+		if (!rbuffer_full(&rb_rx1)) {
+			rbuffer_insert(c, &rb_rx1);
+		}
+	}
+
+	while (received < len) {
+		if (sent < len && (uint16_t)(sent - received) < 2 && (USART1.STATUS & USART_DREIF_bm)) {
+			USART1.TXDATAL = tx ? tx[sent] : (char)0xFF;
+			sent++;
+		}
+		if (USART1.STATUS & USART_RXCIF_bm) {
+			c = USART1.RXDATAL;
+			if (rx) {
+				rx[received] = c;
+			}
+			received++;
+		}
+	}
+
+	USART1.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+uint8_t usart1_mspi_exchange(uint8_t data) {
+	char c = (char)data;
+	usart1_mspi_transfer(&c, &c, 1);
+	return (uint8_t)c;
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart1_init_onewire(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx1.buffer == NULL && !rbuffer_pool_claim(&rb_rx1, RBUFFER_SIZE, &rb_tx1, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx1);							// Init RX1 buffer
+	rbuffer_init(&rb_tx1);							// Init TX1 buffer
+	usart1_echo = 0;
+	usart1_onewire_port_init();						// Defined in uart_settings.h
+    USART1.BAUD = baud_rate; 						// Set BAUD rate
+	USART1.CTRLA |= USART_LBME_bm;					// Loop-back, TxD drives the receiver
+	USART1.CTRLB |= USART_ODME_bm;					// Open-drain TxD
+	USART1.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART1.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Sends request and collects up to rx_len reply bytes. Rx starts when the
+// last request byte has echoed back, i.e. the bus is released. timeout_ms
+// covers both the echo and the reply. Returns number of reply bytes, fewer
+// than rx_len on timeout and 0 if an echo was lost
+uint8_t usart1_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms) {
+	uint32_t timeout = (uint32_t)timeout_ms * 10;	// 100 us ticks
+	uint8_t received = 0;
+
+	if (!(USART1.CTRLB & USART_TXEN_bm)) {
+		return 0;									// Unit closed (or pool exhausted)
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rbuffer_init(&rb_rx1);						// Drop stale input
+	}
+	usart1_send_string((char*)tx, tx_len);
+	while(!rbuffer_empty(&rb_tx1) || usart1_echo) {	// Wait for own bytes to echo back
+		if (!timeout) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rbuffer_init(&rb_tx1);				// Echo lost, drop rest of request
+				usart1_echo = 0;
+			}
+			return 0;
+		}
+		_delay_loop_2(USART_ONEWIRE_TICK);
+		timeout--;
+	}
+
+	while (received < rx_len && timeout) {
+		if (!rbuffer_empty(&rb_rx1)) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rx[received] = rbuffer_remove(&rb_rx1);
+			}
+			received++;
+		}
+		else {
+			_delay_loop_2(USART_ONEWIRE_TICK);
+			timeout--;
+		}
+	}
+	return received;
+}
+#endif
 #endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART2 FUNCTIONS
 #ifdef USART2_ENABLE
 void usart2_send_char(char c) {
+#ifdef RBUFFER_POOL
+	if (rb_tx2.buffer == NULL) {
+		return;										// Unit closed or pool exhausted, drop
+	}
+#endif
 	while(rbuffer_full(&rb_tx2));
 	rbuffer_insert(c, &rb_tx2);
 	USART2.CTRLA |= USART_DREIE_bm;					// Enable Tx interrupt
@@ -223,14 +857,35 @@ int usart2_print_char(char c, FILE *stream) {
 FILE USART2_stream = FDEV_SETUP_STREAM(usart2_print_char, NULL, _FDEV_SETUP_WRITE);
 
 void usart2_init(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx2.buffer == NULL && !rbuffer_pool_claim(&rb_rx2, RBUFFER_SIZE, &rb_tx2, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
 	rbuffer_init(&rb_rx2);							// Init RX2 buffer
 	rbuffer_init(&rb_tx2);							// Init TX2 buffer
+#ifdef USART_ONEWIRE_ENABLE
+	usart2_echo = 0;
+#endif
 	usart2_port_init();								// Defined in uart_settings.h
     USART2.BAUD = baud_rate; 						// Set BAUD rate
 	USART2.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
 	USART2.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
 }
 
+#ifdef RBUFFER_POOL
+bool usart2_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size) {
+	if (USART2.CTRLB & (USART_RXEN_bm | USART_TXEN_bm)) {
+		usart2_close();								// Open unit, finish Tx before rings are released
+	}
+	if (!rbuffer_pool_claim(&rb_rx2, rx_size, &rb_tx2, tx_size)) {
+		return false;								// Pool exhausted, unit stays closed
+	}
+	usart2_init(baud_rate);
+	return true;
+}
+#endif
+
 void usart2_send_string(char* str, uint8_t len) {
 	for (size_t i=0; i<len; i++) {
 		usart2_send_char(str[i]);
@@ -258,13 +913,160 @@ void usart2_close(void) {
 
 	USART2.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt
 	USART2.CTRLA &= ~USART_DREIE_bm;				// Disable Tx interrupt
+
+#ifdef USART_MSPI_ENABLE
+	USART2.CTRLC = USART_CHSIZE_8BIT_gc;			// Back to asynchronous 8N1 (reset value)
+	usart2_mspi_busy = false;
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+	USART2.CTRLA &= ~USART_LBME_bm;				// Disable loop-back
+	USART2.CTRLB &= ~USART_ODME_bm;				// Disable open-drain
+	usart2_echo = 0;								// Echo of last bytes never arrives
+#endif
+
+#ifdef RBUFFER_POOL
+	rbuffer_pool_release(&rb_rx2);					// Return ring buffers to pool
+	rbuffer_pool_release(&rb_tx2);
+#endif
+}
+
+#ifdef USART_MSPI_ENABLE
+void usart2_init_mspi(uint16_t baud_rate, uint8_t mode) {
+#ifdef RBUFFER_POOL
+	if (rb_rx2.buffer == NULL && !rbuffer_pool_claim(&rb_rx2, RBUFFER_SIZE, &rb_tx2, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx2);							// Init RX2 buffer
+	rbuffer_init(&rb_tx2);							// Init TX2 buffer
+	usart2_mspi_busy = false;
+	usart2_mspi_port_init();						// Defined in uart_settings.h
+	USART2.BAUD = baud_rate;						// Set SCK rate, use MSPI_BAUD_RATE()
+	USART2.CTRLC = USART_CMODE_MSPI_gc | mode;		// Master SPI, phase & bit order
+	USART2.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART2.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Full duplex block fast path; tx NULL sends 0xFF, rx NULL discards. Polls
+// DREIF/RXCIF with the Rx interrupt off, instead of two interrupts per byte.
+// At most 2 bytes in flight, so the 2 byte Rx FIFO can never overflow
+void usart2_mspi_transfer(const char* tx, char* rx, uint16_t len) {
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	char c;
+
+	if (!(USART2.CTRLB & USART_TXEN_bm) || (USART2.CTRLC & USART_CMODE_gm) != USART_CMODE_MSPI_gc) {
+		return;										// Unit closed or not in MSPI mode
+	}
+	while(!rbuffer_empty(&rb_tx2)); 				// Let interrupt driven Tx finish
+	USART2.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt, poll instead
+	if (usart2_mspi_busy) {
+		while(!(USART2.STATUS & USART_TXCIF_bm));		// Last byte from Tx ISR clocked out
+		usart2_mspi_busy = false;
+	}
+	while (USART2.STATUS & USART_RXCIF_bm) {			// Its Rx bytes still belong to rb_rx2
+		c = USART2.RXDATAL;
+		if (!rbuffer_full(&rb_rx2)) {
+			rbuffer_insert(c, &rb_rx2);
+		}
+	}
+
+	while (received < len) {
+		if (sent < len && (uint16_t)(sent - received) < 2 && (USART2.STATUS & USART_DREIF_bm)) {
+			USART2.TXDATAL = tx ? tx[sent] : (char)0xFF;
+			sent++;
+		}
+		if (USART2.STATUS & USART_RXCIF_bm) {
+			c = USART2.RXDATAL;
+			if (rx) {
+				rx[received] = c;
+			}
+			received++;
+		}
+	}
+
+	USART2.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+uint8_t usart2_mspi_exchange(uint8_t data) {
+	char c = (char)data;
+	usart2_mspi_transfer(&c, &c, 1);
+	return (uint8_t)c;
 }
 #endif
 
+#ifdef USART_ONEWIRE_ENABLE
+void usart2_init_onewire(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx2.buffer == NULL && !rbuffer_pool_claim(&rb_rx2, RBUFFER_SIZE, &rb_tx2, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx2);							// Init RX2 buffer
+	rbuffer_init(&rb_tx2);							// Init TX2 buffer
+	usart2_echo = 0;
+	usart2_onewire_port_init();						// Defined in uart_settings.h
+    USART2.BAUD = baud_rate; 						// Set BAUD rate
+	USART2.CTRLA |= USART_LBME_bm;					// Loop-back, TxD drives the receiver
+	USART2.CTRLB |= USART_ODME_bm;					// Open-drain TxD
+	USART2.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART2.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Sends request and collects up to rx_len reply bytes. Rx starts when the
+// last request byte has echoed back, i.e. the bus is released. timeout_ms
+// covers both the echo and the reply. Returns number of reply bytes, fewer
+// than rx_len on timeout and 0 if an echo was lost
+uint8_t usart2_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms) {
+	uint32_t timeout = (uint32_t)timeout_ms * 10;	// 100 us ticks
+	uint8_t received = 0;
+
+	if (!(USART2.CTRLB & USART_TXEN_bm)) {
+		return 0;									// Unit closed (or pool exhausted)
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rbuffer_init(&rb_rx2);						// Drop stale input
+	}
+	usart2_send_string((char*)tx, tx_len);
+	while(!rbuffer_empty(&rb_tx2) || usart2_echo) {	// Wait for own bytes to echo back
+		if (!timeout) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rbuffer_init(&rb_tx2);				// Echo lost, drop rest of request
+				usart2_echo = 0;
+			}
+			return 0;
+		}
+		_delay_loop_2(USART_ONEWIRE_TICK);
+		timeout--;
+	}
+
+	while (received < rx_len && timeout) {
+		if (!rbuffer_empty(&rb_rx2)) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rx[received] = rbuffer_remove(&rb_rx2);
+			}
+			received++;
+		}
+		else {
+			_delay_loop_2(USART_ONEWIRE_TICK);
+			timeout--;
+		}
+	}
+	return received;
+}
+#endif
+#endif
+
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART3 FUNCTIONS
 #ifdef USART3_ENABLE
 void usart3_send_char(char c) {
+#ifdef RBUFFER_POOL
+	if (rb_tx3.buffer == NULL) {
+		return;										// Unit closed or pool exhausted, drop
+	}
+#endif
 	while(rbuffer_full(&rb_tx3));
 	rbuffer_insert(c, &rb_tx3);
 	USART3.CTRLA |= USART_DREIE_bm;					// Enable Tx interrupt
@@ -278,14 +1080,35 @@ int usart3_print_char(char c, FILE *stream) {
 FILE USART3_stream = FDEV_SETUP_STREAM(usart3_print_char, NULL, _FDEV_SETUP_WRITE);
 
 void usart3_init(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx3.buffer == NULL && !rbuffer_pool_claim(&rb_rx3, RBUFFER_SIZE, &rb_tx3, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
 	rbuffer_init(&rb_rx3);							// Init RX3 buffer
 	rbuffer_init(&rb_tx3);							// Init TX3 buffer
+#ifdef USART_ONEWIRE_ENABLE
+	usart3_echo = 0;
+#endif
 	usart3_port_init();								// Defined in uart_settings.h
     USART3.BAUD = baud_rate; 						// Set BAUD rate
 	USART3.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
 	USART3.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
 }
 
+#ifdef RBUFFER_POOL
+bool usart3_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size) {
+	if (USART3.CTRLB & (USART_RXEN_bm | USART_TXEN_bm)) {
+		usart3_close();								// Open unit, finish Tx before rings are released
+	}
+	if (!rbuffer_pool_claim(&rb_rx3, rx_size, &rb_tx3, tx_size)) {
+		return false;								// Pool exhausted, unit stays closed
+	}
+	usart3_init(baud_rate);
+	return true;
+}
+#endif
+
 void usart3_send_string(char* str, uint8_t len) {
 	for (size_t i=0; i<len; i++) {
 		usart3_send_char(str[i]);
@@ -313,13 +1136,160 @@ void usart3_close(void) {
 
 	USART3.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt
 	USART3.CTRLA &= ~USART_DREIE_bm;				// Disable Tx interrupt
+
+#ifdef USART_MSPI_ENABLE
+	USART3.CTRLC = USART_CHSIZE_8BIT_gc;			// Back to asynchronous 8N1 (reset value)
+	usart3_mspi_busy = false;
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+	USART3.CTRLA &= ~USART_LBME_bm;				// Disable loop-back
+	USART3.CTRLB &= ~USART_ODME_bm;				// Disable open-drain
+	usart3_echo = 0;								// Echo of last bytes never arrives
+#endif
+
+#ifdef RBUFFER_POOL
+	rbuffer_pool_release(&rb_rx3);					// Return ring buffers to pool
+	rbuffer_pool_release(&rb_tx3);
+#endif
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart3_init_mspi(uint16_t baud_rate, uint8_t mode) {
+#ifdef RBUFFER_POOL
+	if (rb_rx3.buffer == NULL && !rbuffer_pool_claim(&rb_rx3, RBUFFER_SIZE, &rb_tx3, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx3);							// Init RX3 buffer
+	rbuffer_init(&rb_tx3);							// Init TX3 buffer
+	usart3_mspi_busy = false;
+	usart3_mspi_port_init();						// Defined in uart_settings.h
+	USART3.BAUD = baud_rate;						// Set SCK rate, use MSPI_BAUD_RATE()
+	USART3.CTRLC = USART_CMODE_MSPI_gc | mode;		// Master SPI, phase & bit order
+	USART3.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART3.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Full duplex block fast path; tx NULL sends 0xFF, rx NULL discards. Polls
+// DREIF/RXCIF with the Rx interrupt off, instead of two interrupts per byte.
+// At most 2 bytes in flight, so the 2 byte Rx FIFO can never overflow
+void usart3_mspi_transfer(const char* tx, char* rx, uint16_t len) {
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	char c;
+
+	if (!(USART3.CTRLB & USART_TXEN_bm) || (USART3.CTRLC & USART_CMODE_gm) != USART_CMODE_MSPI_gc) {
+		return;										// Unit closed or not in MSPI mode
+	}
+	while(!rbuffer_empty(&rb_tx3)); 				// Let interrupt driven Tx finish
+	USART3.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt, poll instead
+	if (usart3_mspi_busy) {
+		while(!(USART3.STATUS & USART_TXCIF_bm));		// Last byte from Tx ISR clocked out
+		usart3_mspi_busy = false;
+	}
+	while (USART3.STATUS & USART_RXCIF_bm) {			// Its Rx bytes still belong to rb_rx3
+		c = USART3.RXDATAL;
+		if (!rbuffer_full(&rb_rx3)) {
+			rbuffer_insert(c, &rb_rx3);
+		}
+	}
+
+	while (received < len) {
+		if (sent < len && (uint16_t)(sent - received) < 2 && (USART3.STATUS & USART_DREIF_bm)) {
+			USART3.TXDATAL = tx ? tx[sent] : (char)0xFF;
+			sent++;
+		}
+		if (USART3.STATUS & USART_RXCIF_bm) {
+			c = USART3.RXDATAL;
+			if (rx) {
+				rx[received] = c;
+			}
+			received++;
+		}
+	}
+
+	USART3.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+uint8_t usart3_mspi_exchange(uint8_t data) {
+	char c = (char)data;
+	usart3_mspi_transfer(&c, &c, 1);
+	return (uint8_t)c;
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart3_init_onewire(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx3.buffer == NULL && !rbuffer_pool_claim(&rb_rx3, RBUFFER_SIZE, &rb_tx3, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx3);							// Init RX3 buffer
+	rbuffer_init(&rb_tx3);							// Init TX3 buffer
+	usart3_echo = 0;
+	usart3_onewire_port_init();						// Defined in uart_settings.h
+    USART3.BAUD = baud_rate; 						// Set BAUD rate
+	USART3.CTRLA |= USART_LBME_bm;					// Loop-back, TxD drives the receiver
+	USART3.CTRLB |= USART_ODME_bm;					// Open-drain TxD
+	USART3.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART3.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Sends request and collects up to rx_len reply bytes. Rx starts when the
+// last request byte has echoed back, i.e. the bus is released. timeout_ms
+// covers both the echo and the reply. Returns number of reply bytes, fewer
+// than rx_len on timeout and 0 if an echo was lost
+uint8_t usart3_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms) {
+	uint32_t timeout = (uint32_t)timeout_ms * 10;	// 100 us ticks
+	uint8_t received = 0;
+
+	if (!(USART3.CTRLB & USART_TXEN_bm)) {
+		return 0;									// Unit closed (or pool exhausted)
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rbuffer_init(&rb_rx3);						// Drop stale input
+	}
+	usart3_send_string((char*)tx, tx_len);
+	while(!rbuffer_empty(&rb_tx3) || usart3_echo) {	// Wait for own bytes to echo back
+		if (!timeout) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rbuffer_init(&rb_tx3);				// Echo lost, drop rest of request
+				usart3_echo = 0;
+			}
+			return 0;
+		}
+		_delay_loop_2(USART_ONEWIRE_TICK);
+		timeout--;
+	}
+
+	while (received < rx_len && timeout) {
+		if (!rbuffer_empty(&rb_rx3)) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rx[received] = rbuffer_remove(&rb_rx3);
+			}
+			received++;
+		}
+		else {
+			_delay_loop_2(USART_ONEWIRE_TICK);
+			timeout--;
+		}
+	}
+	return received;
+}
+#endif
 #endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART4 FUNCTIONS
 #ifdef USART4_ENABLE
 void usart4_send_char(char c) {
+#ifdef RBUFFER_POOL
+	if (rb_tx4.buffer == NULL) {
+		return;										// Unit closed or pool exhausted, drop
+	}
+#endif
 	while(rbuffer_full(&rb_tx4));
 	rbuffer_insert(c, &rb_tx4);
 	USART4.CTRLA |= USART_DREIE_bm;					// Enable Tx interrupt
@@ -333,14 +1303,35 @@ int usart4_print_char(char c, FILE *stream) {
 FILE USART4_stream = FDEV_SETUP_STREAM(usart4_print_char, NULL, _FDEV_SETUP_WRITE);
 
 void usart4_init(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx4.buffer == NULL && !rbuffer_pool_claim(&rb_rx4, RBUFFER_SIZE, &rb_tx4, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
 	rbuffer_init(&rb_rx4);							// Init RX4 buffer
 	rbuffer_init(&rb_tx4);							// Init TX4 buffer
+#ifdef USART_ONEWIRE_ENABLE
+	usart4_echo = 0;
+#endif
 	usart4_port_init();								// Defined in uart_settings.h
     USART4.BAUD = baud_rate; 						// Set BAUD rate
 	USART4.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
 	USART4.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
 }
 
+#ifdef RBUFFER_POOL
+bool usart4_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size) {
+	if (USART4.CTRLB & (USART_RXEN_bm | USART_TXEN_bm)) {
+		usart4_close();								// Open unit, finish Tx before rings are released
+	}
+	if (!rbuffer_pool_claim(&rb_rx4, rx_size, &rb_tx4, tx_size)) {
+		return false;								// Pool exhausted, unit stays closed
+	}
+	usart4_init(baud_rate);
+	return true;
+}
+#endif
+
 void usart4_send_string(char* str, uint8_t len) {
 	for (size_t i=0; i<len; i++) {
 		usart4_send_char(str[i]);
@@ -368,13 +1359,160 @@ void usart4_close(void) {
 
 	USART4.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt
 	USART4.CTRLA &= ~USART_DREIE_bm;				// Disable Tx interrupt
+
+#ifdef USART_MSPI_ENABLE
+	USART4.CTRLC = USART_CHSIZE_8BIT_gc;			// Back to asynchronous 8N1 (reset value)
+	usart4_mspi_busy = false;
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+	USART4.CTRLA &= ~USART_LBME_bm;				// Disable loop-back
+	USART4.CTRLB &= ~USART_ODME_bm;				// Disable open-drain
+	usart4_echo = 0;								// Echo of last bytes never arrives
+#endif
+
+#ifdef RBUFFER_POOL
+	rbuffer_pool_release(&rb_rx4);					// Return ring buffers to pool
+	rbuffer_pool_release(&rb_tx4);
+#endif
+}
+
+#ifdef USART_MSPI_ENABLE
+void usart4_init_mspi(uint16_t baud_rate, uint8_t mode) {
+#ifdef RBUFFER_POOL
+	if (rb_rx4.buffer == NULL && !rbuffer_pool_claim(&rb_rx4, RBUFFER_SIZE, &rb_tx4, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx4);							// Init RX4 buffer
+	rbuffer_init(&rb_tx4);							// Init TX4 buffer
+	usart4_mspi_busy = false;
+	usart4_mspi_port_init();						// Defined in uart_settings.h
+	USART4.BAUD = baud_rate;						// Set SCK rate, use MSPI_BAUD_RATE()
+	USART4.CTRLC = USART_CMODE_MSPI_gc | mode;		// Master SPI, phase & bit order
+	USART4.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART4.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Full duplex block fast path; tx NULL sends 0xFF, rx NULL discards. Polls
+// DREIF/RXCIF with the Rx interrupt off, instead of two interrupts per byte.
+// At most 2 bytes in flight, so the 2 byte Rx FIFO can never overflow
+void usart4_mspi_transfer(const char* tx, char* rx, uint16_t len) {
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	char c;
+
+	if (!(USART4.CTRLB & USART_TXEN_bm) || (USART4.CTRLC & USART_CMODE_gm) != USART_CMODE_MSPI_gc) {
+		return;										// Unit closed or not in MSPI mode
+	}
+	while(!rbuffer_empty(&rb_tx4)); 				// Let interrupt driven Tx finish
+	USART4.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt, poll instead
+	if (usart4_mspi_busy) {
+		while(!(USART4.STATUS & USART_TXCIF_bm));		// Last byte from Tx ISR clocked out
+		usart4_mspi_busy = false;
+	}
+	while (USART4.STATUS & USART_RXCIF_bm) {			// Its Rx bytes still belong to rb_rx4
+		c = USART4.RXDATAL;
+		if (!rbuffer_full(&rb_rx4)) {
+			rbuffer_insert(c, &rb_rx4);
+		}
+	}
+
+	while (received < len) {
+		if (sent < len && (uint16_t)(sent - received) < 2 && (USART4.STATUS & USART_DREIF_bm)) {
+			USART4.TXDATAL = tx ? tx[sent] : (char)0xFF;
+			sent++;
+		}
+		if (USART4.STATUS & USART_RXCIF_bm) {
+			c = USART4.RXDATAL;
+			if (rx) {
+				rx[received] = c;
+			}
+			received++;
+		}
+	}
+
+	USART4.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+uint8_t usart4_mspi_exchange(uint8_t data) {
+	char c = (char)data;
+	usart4_mspi_transfer(&c, &c, 1);
+	return (uint8_t)c;
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart4_init_onewire(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx4.buffer == NULL && !rbuffer_pool_claim(&rb_rx4, RBUFFER_SIZE, &rb_tx4, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx4);							// Init RX4 buffer
+	rbuffer_init(&rb_tx4);							// Init TX4 buffer
+	usart4_echo = 0;
+	usart4_onewire_port_init();						// Defined in uart_settings.h
+    USART4.BAUD = baud_rate; 						// Set BAUD rate
+	USART4.CTRLA |= USART_LBME_bm;					// Loop-back, TxD drives the receiver
+	USART4.CTRLB |= USART_ODME_bm;					// Open-drain TxD
+	USART4.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART4.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Sends request and collects up to rx_len reply bytes. Rx starts when the
+// last request byte has echoed back, i.e. the bus is released. timeout_ms
+// covers both the echo and the reply. Returns number of reply bytes, fewer
+// than rx_len on timeout and 0 if an echo was lost
+uint8_t usart4_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms) {
+	uint32_t timeout = (uint32_t)timeout_ms * 10;	// 100 us ticks
+	uint8_t received = 0;
+
+	if (!(USART4.CTRLB & USART_TXEN_bm)) {
+		return 0;									// Unit closed (or pool exhausted)
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rbuffer_init(&rb_rx4);						// Drop stale input
+	}
+	usart4_send_string((char*)tx, tx_len);
+	while(!rbuffer_empty(&rb_tx4) || usart4_echo) {	// Wait for own bytes to echo back
+		if (!timeout) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rbuffer_init(&rb_tx4);				// Echo lost, drop rest of request
+				usart4_echo = 0;
+			}
+			return 0;
+		}
+		_delay_loop_2(USART_ONEWIRE_TICK);
+		timeout--;
+	}
+
+	while (received < rx_len && timeout) {
+		if (!rbuffer_empty(&rb_rx4)) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rx[received] = rbuffer_remove(&rb_rx4);
+			}
+			received++;
+		}
+		else {
+			_delay_loop_2(USART_ONEWIRE_TICK);
+			timeout--;
+		}
+	}
+	return received;
 }
 #endif
+#endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART5 FUNCTIONS
 #ifdef USART5_ENABLE
 void usart5_send_char(char c) {
+#ifdef RBUFFER_POOL
+	if (rb_tx5.buffer == NULL) {
+		return;										// Unit closed or pool exhausted, drop
+	}
+#endif
 	while(rbuffer_full(&rb_tx5));
 	rbuffer_insert(c, &rb_tx5);
 	USART5.CTRLA |= USART_DREIE_bm;					// Enable Tx interrupt
@@ -388,14 +1526,35 @@ int usart5_print_char(char c, FILE *stream) {
 FILE USART5_stream = FDEV_SETUP_STREAM(usart5_print_char, NULL, _FDEV_SETUP_WRITE);
 
 void usart5_init(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx5.buffer == NULL && !rbuffer_pool_claim(&rb_rx5, RBUFFER_SIZE, &rb_tx5, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
 	rbuffer_init(&rb_rx5);							// Init RX5 buffer
 	rbuffer_init(&rb_tx5);							// Init TX5 buffer
+#ifdef USART_ONEWIRE_ENABLE
+	usart5_echo = 0;
+#endif
 	usart5_port_init();								// Defined in uart_settings.h
     USART5.BAUD = baud_rate; 						// Set BAUD rate
 	USART5.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
 	USART5.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
 }
 
+#ifdef RBUFFER_POOL
+bool usart5_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size) {
+	if (USART5.CTRLB & (USART_RXEN_bm | USART_TXEN_bm)) {
+		usart5_close();								// Open unit, finish Tx before rings are released
+	}
+	if (!rbuffer_pool_claim(&rb_rx5, rx_size, &rb_tx5, tx_size)) {
+		return false;								// Pool exhausted, unit stays closed
+	}
+	usart5_init(baud_rate);
+	return true;
+}
+#endif
+
 void usart5_send_string(char* str, uint8_t len) {
 	for (size_t i=0; i<len; i++) {
 		usart5_send_char(str[i]);
@@ -423,119 +1582,441 @@ void usart5_close(void) {
 
 	USART5.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt
 	USART5.CTRLA &= ~USART_DREIE_bm;				// Disable Tx interrupt
+
+#ifdef USART_MSPI_ENABLE
+	USART5.CTRLC = USART_CHSIZE_8BIT_gc;			// Back to asynchronous 8N1 (reset value)
+	usart5_mspi_busy = false;
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+	USART5.CTRLA &= ~USART_LBME_bm;				// Disable loop-back
+	USART5.CTRLB &= ~USART_ODME_bm;				// Disable open-drain
+	usart5_echo = 0;								// Echo of last bytes never arrives
+#endif
+
+#ifdef RBUFFER_POOL
+	rbuffer_pool_release(&rb_rx5);					// Return ring buffers to pool
+	rbuffer_pool_release(&rb_tx5);
+#endif
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart5_init_mspi(uint16_t baud_rate, uint8_t mode) {
+#ifdef RBUFFER_POOL
+	if (rb_rx5.buffer == NULL && !rbuffer_pool_claim(&rb_rx5, RBUFFER_SIZE, &rb_tx5, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx5);							// Init RX5 buffer
+	rbuffer_init(&rb_tx5);							// Init TX5 buffer
+	usart5_mspi_busy = false;
+	usart5_mspi_port_init();						// Defined in uart_settings.h
+	USART5.BAUD = baud_rate;						// Set SCK rate, use MSPI_BAUD_RATE()
+	USART5.CTRLC = USART_CMODE_MSPI_gc | mode;		// Master SPI, phase & bit order
+	USART5.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART5.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Full duplex block fast path; tx NULL sends 0xFF, rx NULL discards. Polls
+// DREIF/RXCIF with the Rx interrupt off, instead of two interrupts per byte.
+// At most 2 bytes in flight, so the 2 byte Rx FIFO can never overflow
+void usart5_mspi_transfer(const char* tx, char* rx, uint16_t len) {
+	uint16_t sent = 0;
+	uint16_t received = 0;
+	char c;
+
+	if (!(USART5.CTRLB & USART_TXEN_bm) || (USART5.CTRLC & USART_CMODE_gm) != USART_CMODE_MSPI_gc) {
+		return;										// Unit closed or not in MSPI mode
+	}
+	while(!rbuffer_empty(&rb_tx5)); 				// Let interrupt driven Tx finish
+	USART5.CTRLA &= ~USART_RXCIE_bm;				// Disable Rx interrupt, poll instead
+	if (usart5_mspi_busy) {
+		while(!(USART5.STATUS & USART_TXCIF_bm));		// Last byte from Tx ISR clocked out
+		usart5_mspi_busy = false;
+	}
+	while (USART5.STATUS & USART_RXCIF_bm) {			// Its Rx bytes still belong to rb_rx5
+		c = USART5.RXDATAL;
+		if (!rbuffer_full(&rb_rx5)) {
+			rbuffer_insert(c, &rb_rx5);
+		}
+	}
+
+	while (received < len) {
+		if (sent < len && (uint16_t)(sent - received) < 2 && (USART5.STATUS & USART_DREIF_bm)) {
+			USART5.TXDATAL = tx ? tx[sent] : (char)0xFF;
+			sent++;
+		}
+		if (USART5.STATUS & USART_RXCIF_bm) {
+			c = USART5.RXDATAL;
+			if (rx) {
+				rx[received] = c;
+			}
+			received++;
+		}
+	}
+
+	USART5.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+uint8_t usart5_mspi_exchange(uint8_t data) {
+	char c = (char)data;
+	usart5_mspi_transfer(&c, &c, 1);
+	return (uint8_t)c;
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart5_init_onewire(uint16_t baud_rate) {
+#ifdef RBUFFER_POOL
+	if (rb_rx5.buffer == NULL && !rbuffer_pool_claim(&rb_rx5, RBUFFER_SIZE, &rb_tx5, RBUFFER_SIZE)) {
+		return;										// Pool exhausted, unit stays closed
+	}
+#endif
+	rbuffer_init(&rb_rx5);							// Init RX5 buffer
+	rbuffer_init(&rb_tx5);							// Init TX5 buffer
+	usart5_echo = 0;
+	usart5_onewire_port_init();						// Defined in uart_settings.h
+    USART5.BAUD = baud_rate; 						// Set BAUD rate
+	USART5.CTRLA |= USART_LBME_bm;					// Loop-back, TxD drives the receiver
+	USART5.CTRLB |= USART_ODME_bm;					// Open-drain TxD
+	USART5.CTRLB |= USART_RXEN_bm | USART_TXEN_bm; 	// Enable Rx & Enable Tx 
+	USART5.CTRLA |= USART_RXCIE_bm ; 				// Enable Rx interrupt 
+}
+
+// Sends request and collects up to rx_len reply bytes. Rx starts when the
+// last request byte has echoed back, i.e. the bus is released. timeout_ms
+// covers both the echo and the reply. Returns number of reply bytes, fewer
+// than rx_len on timeout and 0 if an echo was lost
+uint8_t usart5_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms) {
+	uint32_t timeout = (uint32_t)timeout_ms * 10;	// 100 us ticks
+	uint8_t received = 0;
+
+	if (!(USART5.CTRLB & USART_TXEN_bm)) {
+		return 0;									// Unit closed (or pool exhausted)
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rbuffer_init(&rb_rx5);						// Drop stale input
+	}
+	usart5_send_string((char*)tx, tx_len);
+	while(!rbuffer_empty(&rb_tx5) || usart5_echo) {	// Wait for own bytes to echo back
+		if (!timeout) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rbuffer_init(&rb_tx5);				// Echo lost, drop rest of request
+				usart5_echo = 0;
+			}
+			return 0;
+		}
+		_delay_loop_2(USART_ONEWIRE_TICK);
+		timeout--;
+	}
+
+	while (received < rx_len && timeout) {
+		if (!rbuffer_empty(&rb_rx5)) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				rx[received] = rbuffer_remove(&rb_rx5);
+			}
+			received++;
+		}
+		else {
+			_delay_loop_2(USART_ONEWIRE_TICK);
+			timeout--;
+		}
+	}
+	return received;
+}
+#endif
 #endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART0 ISR FUNCTIONS
 #ifdef USART0_ENABLE
+#ifdef USART_ISR_NAKED
+ISR(USART0_RXC_vect, ISR_NAKED) {
+	USART_RXC_NAKED(USART0, rb_rx0, usart0_error);
+}
+
+ISR(USART0_DRE_vect, ISR_NAKED) {
+	USART_DRE_NAKED(USART0, rb_tx0);
+}
+#else
 ISR(USART0_RXC_vect) {
     char data = USART0.RXDATAL;
+#ifdef USART_ONEWIRE_ENABLE
+	if (usart0_echo) {
+		usart0_echo--;								// Own byte echoed back, discard
+		return;
+	}
+#endif
+#ifdef USART_MSPI_ENABLE
+	if (rbuffer_full(&rb_rx0)) {
+		return;										// Every byte sent is received, drop unread
+	}
+#endif
 	rbuffer_insert(data, &rb_rx0);
 	usart0_error = USART0.RXDATAH;
 }
 
 ISR(USART0_DRE_vect) {
 	if(!rbuffer_empty(&rb_tx0)) {
+#ifdef USART_MSPI_ENABLE
+		USART0.STATUS = USART_TXCIF_bm;				// Tx complete then marks the last byte out
+		usart0_mspi_busy = true;
+#endif
 		USART0.TXDATAL = rbuffer_remove(&rb_tx0);
+#ifdef USART_ONEWIRE_ENABLE
+		if (USART0.CTRLA & USART_LBME_bm) {
+			usart0_echo++;							// Expect echo in one-wire mode
+		}
+#endif
 	}
 	else {
 		USART0.CTRLA &= ~USART_DREIE_bm;
 	}
 }
 #endif
+#endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART1 ISR FUNCTIONS
 #ifdef USART1_ENABLE
+#ifdef USART_ISR_NAKED
+ISR(USART1_RXC_vect, ISR_NAKED) {
+	USART_RXC_NAKED(USART1, rb_rx1, usart1_error);
+}
+
+ISR(USART1_DRE_vect, ISR_NAKED) {
+	USART_DRE_NAKED(USART1, rb_tx1);
+}
+#else
 ISR(USART1_RXC_vect) {
     char data = USART1.RXDATAL;
+#ifdef USART_ONEWIRE_ENABLE
+	if (usart1_echo) {
+		usart1_echo--;								// Own byte echoed back, discard
+		return;
+	}
+#endif
+#ifdef USART_MSPI_ENABLE
+	if (rbuffer_full(&rb_rx1)) {
+		return;										// Every byte sent is received, drop unread
+	}
+#endif
 	rbuffer_insert(data, &rb_rx1);
 	usart1_error = USART1.RXDATAH;
 }
 
 ISR(USART1_DRE_vect) {
 	if(!rbuffer_empty(&rb_tx1)) {
+#ifdef USART_MSPI_ENABLE
+		USART1.STATUS = USART_TXCIF_bm;				// Tx complete then marks the last byte out
+		usart1_mspi_busy = true;
+#endif
 		USART1.TXDATAL = rbuffer_remove(&rb_tx1);
+#ifdef USART_ONEWIRE_ENABLE
+		if (USART1.CTRLA & USART_LBME_bm) {
+			usart1_echo++;							// Expect echo in one-wire mode
+		}
+#endif
 	}
 	else {
 		USART1.CTRLA &= ~USART_DREIE_bm;
 	}
 }
 #endif
+#endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART2 ISR FUNCTIONS
 #ifdef USART2_ENABLE
+#ifdef USART_ISR_NAKED
+ISR(USART2_RXC_vect, ISR_NAKED) {
+	USART_RXC_NAKED(USART2, rb_rx2, usart2_error);
+}
+
+ISR(USART2_DRE_vect, ISR_NAKED) {
+	USART_DRE_NAKED(USART2, rb_tx2);
+}
+#else
 ISR(USART2_RXC_vect) {
     char data = USART2.RXDATAL;
+#ifdef USART_ONEWIRE_ENABLE
+	if (usart2_echo) {
+		usart2_echo--;								// Own byte echoed back, discard
+		return;
+	}
+#endif
+#ifdef USART_MSPI_ENABLE
+	if (rbuffer_full(&rb_rx2)) {
+		return;										// Every byte sent is received, drop unread
+	}
+#endif
 	rbuffer_insert(data, &rb_rx2);
 	usart2_error = USART2.RXDATAH;
 }
 
 ISR(USART2_DRE_vect) {
 	if(!rbuffer_empty(&rb_tx2)) {
+#ifdef USART_MSPI_ENABLE
+		USART2.STATUS = USART_TXCIF_bm;				// Tx complete then marks the last byte out
+		usart2_mspi_busy = true;
+#endif
 		USART2.TXDATAL = rbuffer_remove(&rb_tx2);
+#ifdef USART_ONEWIRE_ENABLE
+		if (USART2.CTRLA & USART_LBME_bm) {
+			usart2_echo++;							// Expect echo in one-wire mode
+		}
+#endif
 	}
 	else {
 		USART2.CTRLA &= ~USART_DREIE_bm;
 	}
 }
 #endif
+#endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART3 ISR FUNCTIONS
 #ifdef USART3_ENABLE
+#ifdef USART_ISR_NAKED
+ISR(USART3_RXC_vect, ISR_NAKED) {
+	USART_RXC_NAKED(USART3, rb_rx3, usart3_error);
+}
+
+ISR(USART3_DRE_vect, ISR_NAKED) {
+	USART_DRE_NAKED(USART3, rb_tx3);
+}
+#else
 ISR(USART3_RXC_vect) {
     char data = USART3.RXDATAL;
+#ifdef USART_ONEWIRE_ENABLE
+	if (usart3_echo) {
+		usart3_echo--;								// Own byte echoed back, discard
+		return;
+	}
+#endif
+#ifdef USART_MSPI_ENABLE
+	if (rbuffer_full(&rb_rx3)) {
+		return;										// Every byte sent is received, drop unread
+	}
+#endif
 	rbuffer_insert(data, &rb_rx3);
-	usart3_error = USART0.RXDATAH;
+	usart3_error = USART3.RXDATAH;
 }
 
 ISR(USART3_DRE_vect) {
 	if(!rbuffer_empty(&rb_tx3)) {
+#ifdef USART_MSPI_ENABLE
+		USART3.STATUS = USART_TXCIF_bm;				// Tx complete then marks the last byte out
+		usart3_mspi_busy = true;
+#endif
 		USART3.TXDATAL = rbuffer_remove(&rb_tx3);
+#ifdef USART_ONEWIRE_ENABLE
+		if (USART3.CTRLA & USART_LBME_bm) {
+			usart3_echo++;							// Expect echo in one-wire mode
+		}
+#endif
 	}
 	else {
 		USART3.CTRLA &= ~USART_DREIE_bm;
 	}
 }
 #endif
+#endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART4 ISR FUNCTIONS
 #ifdef USART4_ENABLE
+#ifdef USART_ISR_NAKED
+ISR(USART4_RXC_vect, ISR_NAKED) {
+	USART_RXC_NAKED(USART4, rb_rx4, usart4_error);
+}
+
+ISR(USART4_DRE_vect, ISR_NAKED) {
+	USART_DRE_NAKED(USART4, rb_tx4);
+}
+#else
 ISR(USART4_RXC_vect) {
     char data = USART4.RXDATAL;
+#ifdef USART_ONEWIRE_ENABLE
+	if (usart4_echo) {
+		usart4_echo--;								// Own byte echoed back, discard
+		return;
+	}
+#endif
+#ifdef USART_MSPI_ENABLE
+	if (rbuffer_full(&rb_rx4)) {
+		return;										// Every byte sent is received, drop unread
+	}
+#endif
 	rbuffer_insert(data, &rb_rx4);
 	usart4_error = USART4.RXDATAH;
 }
 
 ISR(USART4_DRE_vect) {
 	if(!rbuffer_empty(&rb_tx4)) {
+#ifdef USART_MSPI_ENABLE
+		USART4.STATUS = USART_TXCIF_bm;				// Tx complete then marks the last byte out
+		usart4_mspi_busy = true;
+#endif
 		USART4.TXDATAL = rbuffer_remove(&rb_tx4);
+#ifdef USART_ONEWIRE_ENABLE
+		if (USART4.CTRLA & USART_LBME_bm) {
+			usart4_echo++;							// Expect echo in one-wire mode
+		}
+#endif
 	}
 	else {
 		USART4.CTRLA &= ~USART_DREIE_bm;
 	}
 }
 #endif
+#endif
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART5 ISR FUNCTIONS
 #ifdef USART5_ENABLE
+#ifdef USART_ISR_NAKED
+ISR(USART5_RXC_vect, ISR_NAKED) {
+	USART_RXC_NAKED(USART5, rb_rx5, usart5_error);
+}
+
+ISR(USART5_DRE_vect, ISR_NAKED) {
+	USART_DRE_NAKED(USART5, rb_tx5);
+}
+#else
 ISR(USART5_RXC_vect) {
     char data = USART5.RXDATAL;
+#ifdef USART_ONEWIRE_ENABLE
+	if (usart5_echo) {
+		usart5_echo--;								// Own byte echoed back, discard
+		return;
+	}
+#endif
+#ifdef USART_MSPI_ENABLE
+	if (rbuffer_full(&rb_rx5)) {
+		return;										// Every byte sent is received, drop unread
+	}
+#endif
 	rbuffer_insert(data, &rb_rx5);
 	usart5_error = USART5.RXDATAH;
 }
 
 ISR(USART5_DRE_vect) {
 	if(!rbuffer_empty(&rb_tx5)) {
+#ifdef USART_MSPI_ENABLE
+		USART5.STATUS = USART_TXCIF_bm;				// Tx complete then marks the last byte out
+		usart5_mspi_busy = true;
+#endif
 		USART5.TXDATAL = rbuffer_remove(&rb_tx5);
+#ifdef USART_ONEWIRE_ENABLE
+		if (USART5.CTRLA & USART_LBME_bm) {
+			usart5_echo++;							// Expect echo in one-wire mode
+		}
+#endif
 	}
 	else {
 		USART5.CTRLA &= ~USART_DREIE_bm;
 	}
 }
+#endif
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "uart_settings.h"
 
 #define USART_BUFFER_OVERFLOW    0x6400      // ==USART_BUFOVF_bm  
@@ -16,58 +17,146 @@
 
 #define BAUD_RATE(BAUD_RATE) ((float)(F_CPU * 64 / (16 * (float)BAUD_RATE)) + 0.5)
 
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// MASTER SPI (MSPI); SCK = F_CPU / (2 * BAUD[15:6]), max F_CPU / 2
+#define MSPI_BAUD_RATE(SCK_RATE) ((uint16_t)((F_CPU / (2 * (uint32_t)(SCK_RATE))) << 6))
+
+#define USART_MSPI_MODE0         0x00                // CPHA=0, MSB first
+#define USART_MSPI_CPHA          USART_UCPHA_bm      // Sample on trailing edge
+#define USART_MSPI_LSB_FIRST     USART_UDORD_bm      // CPOL is set with INVEN on XCK pin
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// RINGBUFFER POOL FUNCTIONS
+#ifdef RBUFFER_POOL
+uint16_t usart_pool_free(void);
+uint16_t usart_pool_largest(void);
+uint8_t usart_pool_fragmentation(void);
+#endif
+
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // USART FUNCTIONS
 #ifdef USART0_ENABLE
 extern FILE USART0_stream;
 void usart0_init(uint16_t baud_rate);
+#ifdef RBUFFER_POOL
+bool usart0_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size);
+#endif
 void usart0_send_char(char c);
 void usart0_send_string(char* str, uint8_t len);
 uint16_t usart0_read_char(void);
 void usart0_close(void);
+#ifdef USART_MSPI_ENABLE
+void usart0_init_mspi(uint16_t baud_rate, uint8_t mode);
+void usart0_mspi_transfer(const char* tx, char* rx, uint16_t len);
+uint8_t usart0_mspi_exchange(uint8_t data);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart0_init_onewire(uint16_t baud_rate);
+uint8_t usart0_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms);
+#endif
 #endif
 
 #ifdef USART1_ENABLE
 extern FILE USART1_stream;
 void usart1_init(uint16_t baud_rate);
+#ifdef RBUFFER_POOL
+bool usart1_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size);
+#endif
 void usart1_send_char(char c);
 void usart1_send_string(char* str, uint8_t len);
 uint16_t usart1_read_char(void);
 void usart1_close(void);
+#ifdef USART_MSPI_ENABLE
+void usart1_init_mspi(uint16_t baud_rate, uint8_t mode);
+void usart1_mspi_transfer(const char* tx, char* rx, uint16_t len);
+uint8_t usart1_mspi_exchange(uint8_t data);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart1_init_onewire(uint16_t baud_rate);
+uint8_t usart1_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms);
+#endif
 #endif
 
 #ifdef USART2_ENABLE
 extern FILE USART2_stream;
 void usart2_init(uint16_t baud_rate);
+#ifdef RBUFFER_POOL
+bool usart2_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size);
+#endif
 void usart2_send_char(char c);
 void usart2_send_string(char* str, uint8_t len);
 uint16_t usart2_read_char(void);
 void usart2_close(void);
+#ifdef USART_MSPI_ENABLE
+void usart2_init_mspi(uint16_t baud_rate, uint8_t mode);
+void usart2_mspi_transfer(const char* tx, char* rx, uint16_t len);
+uint8_t usart2_mspi_exchange(uint8_t data);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart2_init_onewire(uint16_t baud_rate);
+uint8_t usart2_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms);
+#endif
 #endif
 
 #ifdef USART3_ENABLE
 extern FILE USART3_stream;
 void usart3_init(uint16_t baud_rate);
+#ifdef RBUFFER_POOL
+bool usart3_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size);
+#endif
 void usart3_send_char(char c);
 void usart3_send_string(char* str, uint8_t len);
 uint16_t usart3_read_char(void);
 void usart3_close(void);
+#ifdef USART_MSPI_ENABLE
+void usart3_init_mspi(uint16_t baud_rate, uint8_t mode);
+void usart3_mspi_transfer(const char* tx, char* rx, uint16_t len);
+uint8_t usart3_mspi_exchange(uint8_t data);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart3_init_onewire(uint16_t baud_rate);
+uint8_t usart3_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms);
+#endif
 #endif
 
 #ifdef USART4_ENABLE
 extern FILE USART4_stream;
 void usart4_init(uint16_t baud_rate);
+#ifdef RBUFFER_POOL
+bool usart4_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size);
+#endif
 void usart4_send_char(char c);
 void usart4_send_string(char* str, uint8_t len);
 uint16_t usart4_read_char(void);
 void usart4_close(void);
+#ifdef USART_MSPI_ENABLE
+void usart4_init_mspi(uint16_t baud_rate, uint8_t mode);
+void usart4_mspi_transfer(const char* tx, char* rx, uint16_t len);
+uint8_t usart4_mspi_exchange(uint8_t data);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart4_init_onewire(uint16_t baud_rate);
+uint8_t usart4_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms);
+#endif
 #endif
 
 #ifdef USART5_ENABLE
 extern FILE USART5_stream;
 void usart5_init(uint16_t baud_rate);
+#ifdef RBUFFER_POOL
+bool usart5_init_size(uint16_t baud_rate, uint8_t rx_size, uint8_t tx_size);
+#endif
 void usart5_send_char(char c);
 void usart5_send_string(char* str, uint8_t len);
 uint16_t usart5_read_char(void);
 void usart5_close(void);
+#ifdef USART_MSPI_ENABLE
+void usart5_init_mspi(uint16_t baud_rate, uint8_t mode);
+void usart5_mspi_transfer(const char* tx, char* rx, uint16_t len);
+uint8_t usart5_mspi_exchange(uint8_t data);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart5_init_onewire(uint16_t baud_rate);
+uint8_t usart5_onewire_request(const char* tx, uint8_t tx_len, char* rx, uint8_t rx_len, uint16_t timeout_ms);
+#endif
 #endif
\ No newline at end of file
@@ -18,6 +18,34 @@ void usart0_port_init(void) {
     PORTA.DIR &= ~PIN1_bm;			    // Rx
     PORTA.DIR |= PIN0_bm;			    // Tx
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart0_mspi_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    PORTA.DIR &= ~PIN1_bm;			    // MISO (Rx)
+    PORTA.DIR |= PIN0_bm;			    // MOSI (Tx)
+    PORTA.DIR |= PIN2_bm;			    // SCK (XCK)
+    PORTA.OUTSET = PIN3_bm;			    // CS, idle high
+    PORTA.DIR |= PIN3_bm;
+}
+
+void usart0_mspi_select(bool select) {
+    if (select) {
+        PORTA.OUTCLR = PIN3_bm;         // CS low
+    }
+    else {
+        PORTA.OUTSET = PIN3_bm;         // CS high
+    }
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart0_onewire_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    PORTA.PIN0CTRL |= PORT_PULLUPEN_bm; // Bus pull-up (or external resistor)
+    PORTA.DIR |= PIN0_bm;			    // Tx, open-drain bus pin
+}
+#endif
 #endif
 
 #ifdef USART1_ENABLE
@@ -26,6 +54,28 @@ void usart1_port_init(void) {
     asm("NOP");                         // Rx
     asm("NOP");                         // Tx
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart1_mspi_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // MISO (Rx)
+    asm("NOP");                         // MOSI (Tx)
+    asm("NOP");                         // SCK (XCK)
+    asm("NOP");                         // CS, idle high
+}
+
+void usart1_mspi_select(bool select) {
+    asm("NOP");                         // CS low if select, otherwise high
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart1_onewire_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // Bus pull-up (or external resistor)
+    asm("NOP");                         // Tx, open-drain bus pin
+}
+#endif
 #endif
 
 #ifdef USART2_ENABLE
@@ -34,6 +84,28 @@ void usart2_port_init(void) {
     asm("NOP");                         // Rx
     asm("NOP");                         // Tx
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart2_mspi_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // MISO (Rx)
+    asm("NOP");                         // MOSI (Tx)
+    asm("NOP");                         // SCK (XCK)
+    asm("NOP");                         // CS, idle high
+}
+
+void usart2_mspi_select(bool select) {
+    asm("NOP");                         // CS low if select, otherwise high
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart2_onewire_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // Bus pull-up (or external resistor)
+    asm("NOP");                         // Tx, open-drain bus pin
+}
+#endif
 #endif
 
 #ifdef USART3_ENABLE
@@ -42,6 +114,28 @@ void usart3_port_init(void) {
     PORTB.DIR &= ~PIN5_bm;              // Rx
     PORTB.DIR |= PIN4_bm;               // Tx
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart3_mspi_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // MISO (Rx)
+    asm("NOP");                         // MOSI (Tx)
+    asm("NOP");                         // SCK (XCK)
+    asm("NOP");                         // CS, idle high
+}
+
+void usart3_mspi_select(bool select) {
+    asm("NOP");                         // CS low if select, otherwise high
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart3_onewire_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // Bus pull-up (or external resistor)
+    asm("NOP");                         // Tx, open-drain bus pin
+}
+#endif
 #endif
 
 #ifdef USART4_ENABLE
@@ -50,6 +144,28 @@ void usart4_port_init(void) {
     asm("NOP");                         // Rx
     asm("NOP");                         // Tx
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart4_mspi_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // MISO (Rx)
+    asm("NOP");                         // MOSI (Tx)
+    asm("NOP");                         // SCK (XCK)
+    asm("NOP");                         // CS, idle high
+}
+
+void usart4_mspi_select(bool select) {
+    asm("NOP");                         // CS low if select, otherwise high
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart4_onewire_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // Bus pull-up (or external resistor)
+    asm("NOP");                         // Tx, open-drain bus pin
+}
+#endif
 #endif
 
 #ifdef USART5_ENABLE
@@ -58,4 +174,26 @@ void usart5_port_init(void) {
     asm("NOP");                         // Rx
     asm("NOP");                         // Tx
 }
+
+#ifdef USART_MSPI_ENABLE
+void usart5_mspi_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // MISO (Rx)
+    asm("NOP");                         // MOSI (Tx)
+    asm("NOP");                         // SCK (XCK)
+    asm("NOP");                         // CS, idle high
+}
+
+void usart5_mspi_select(bool select) {
+    asm("NOP");                         // CS low if select, otherwise high
+}
+#endif
+
+#ifdef USART_ONEWIRE_ENABLE
+void usart5_onewire_port_init(void) {
+    asm("NOP");                         // PORTMUX
+    asm("NOP");                         // Bus pull-up (or external resistor)
+    asm("NOP");                         // Tx, open-drain bus pin
+}
+#endif
 #endif
\ No newline at end of file
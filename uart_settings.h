@@ -6,11 +6,18 @@
  *          Date:     Uppsala, 2023-05-08           
  */
 
+#include <stdbool.h>
 
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // DEFINE RING BUFFER SIZE; MUST BE 2, 4, 8, 16, 32, 64 or 128  
 #define RBUFFER_SIZE 32  
 
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// SHARED RING BUFFER POOL (UNCOMMENT TO ENABLE)
+// Rx and Tx buffers are claimed from one arena in usartN_init and returned in usartN_close
+// #define RBUFFER_POOL
+#define RBUFFER_POOL_SIZE 128
+
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // ENABLE USART UNITS (UNCOMMENT USARTn TO ENABLE)
 #define USART0_ENABLE
@@ -20,28 +27,87 @@
 // #define USART4_ENABLE
 // #define USART5_ENABLE
 
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// HAND TUNED ISR_NAKED INTERRUPTS (UNCOMMENT TO ENABLE)
+// #define USART_ISR_NAKED
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// MASTER SPI MODE, usartN_init_mspi() (UNCOMMENT TO ENABLE)
+// #define USART_MSPI_ENABLE
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// SINGLE-WIRE HALF-DUPLEX MODE, usartN_init_onewire() (UNCOMMENT TO ENABLE)
+// #define USART_ONEWIRE_ENABLE
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// DEFERRED BINARY LOGGING, ULOG() IN ulog.h (UNCOMMENT TO ENABLE)
+// #define ULOG_ENABLE
+#define ULOG_SEND_CHAR usart0_send_char
+
 // ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
 // PORTMUX & PINOUT (DO NOT TOUCH THESE)
 #ifdef USART0_ENABLE
 void usart0_port_init(void);
+#ifdef USART_MSPI_ENABLE
+void usart0_mspi_port_init(void);
+void usart0_mspi_select(bool select);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart0_onewire_port_init(void);
+#endif
 #endif
 
 #ifdef USART1_ENABLE
 void usart1_port_init(void);
+#ifdef USART_MSPI_ENABLE
+void usart1_mspi_port_init(void);
+void usart1_mspi_select(bool select);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart1_onewire_port_init(void);
+#endif
 #endif
 
 #ifdef USART2_ENABLE
 void usart2_port_init(void);
+#ifdef USART_MSPI_ENABLE
+void usart2_mspi_port_init(void);
+void usart2_mspi_select(bool select);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart2_onewire_port_init(void);
+#endif
 #endif
 
 #ifdef USART3_ENABLE
 void usart3_port_init(void);
+#ifdef USART_MSPI_ENABLE
+void usart3_mspi_port_init(void);
+void usart3_mspi_select(bool select);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart3_onewire_port_init(void);
+#endif
 #endif
 
 #ifdef USART4_ENABLE
 void usart4_port_init(void);
+#ifdef USART_MSPI_ENABLE
+void usart4_mspi_port_init(void);
+void usart4_mspi_select(bool select);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart4_onewire_port_init(void);
+#endif
 #endif
 
 #ifdef USART5_ENABLE
 void usart5_port_init(void);
+#ifdef USART_MSPI_ENABLE
+void usart5_mspi_port_init(void);
+void usart5_mspi_select(bool select);
+#endif
+#ifdef USART_ONEWIRE_ENABLE
+void usart5_onewire_port_init(void);
+#endif
 #endif
\ No newline at end of file
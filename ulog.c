@@ -0,0 +1,49 @@
+/*
+ *     ulog.c
+ *
+ *          Project:  UART for megaAVR, tinyAVR & AVR DA
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "uart_settings.h"
+#include "uart.h"
+#include "ulog.h"
+
+#ifdef ULOG_ENABLE
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// ULOG FUNCTIONS (CALLED BY ULOG MACRO)
+void ulog_put_id(uint16_t id) {
+	ULOG_SEND_CHAR((char)id);
+	ULOG_SEND_CHAR((char)(id >> 8));
+}
+
+void ulog_put_value(uint32_t value, uint8_t size) {
+	for (uint8_t i=0; i<size && i<4; i++) {
+		ULOG_SEND_CHAR((char)value);
+		value >>= 8;
+	}
+}
+
+void ulog_put_value64(uint64_t value, uint8_t size) {
+	ulog_put_value((uint32_t)value, 4);
+	ulog_put_value((uint32_t)(value >> 32), 4);
+}
+
+void ulog_put_float(float value, uint8_t size) {
+	uint32_t raw;
+	memcpy(&raw, &value, sizeof(raw));				// Host reads IEEE 754 single
+	ulog_put_value(raw, sizeof(raw));
+}
+
+void ulog_put_pointer(const void* ptr, uint8_t size) {
+	ulog_put_value((uint32_t)(uintptr_t)ptr, sizeof(ptr));
+}
+
+void ulog_put_string(const void* str, uint8_t size) {
+	const char* c = str;
+	do {
+		ULOG_SEND_CHAR(*c);							// Including NUL
+	} while (*c++);
+}
+#endif
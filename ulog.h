@@ -0,0 +1,72 @@
+/*
+ *     ulog.h
+ *
+ *          Project:  UART for megaAVR, tinyAVR & AVR DA
+ */
+
+#include <stdint.h>
+#include "uart_settings.h"
+
+// ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ---- ----
+// DEFERRED BINARY LOGGING
+// ULOG(fmt, ...) sends a 16-bit format ID followed by the raw argument bytes
+// (little endian, integers promoted to int/long/long long, float as 4 bytes,
+// pointers as %p, char pointers as NUL terminated strings). The format
+// strings are kept in the non-loaded ELF section .ulog, the ID is the offset
+// into it. Decode with tools/ulog_decode
+#ifdef ULOG_ENABLE
+
+// ';' comments out the flags gcc appends, so .ulog is not allocated in flash
+#ifndef ULOG_SECTION
+#define ULOG_SECTION ".ulog,\"\",@progbits ;"
+#endif
+
+#define ULOG(fmt, ...) do {                                                             \
+    static const char ulog_fmt[] __attribute__((section(ULOG_SECTION), used)) = fmt;    \
+    ulog_put_id((uint16_t)(uintptr_t)ulog_fmt);                                         \
+    ULOG_ARGS(__VA_ARGS__)                                                              \
+} while (0)
+
+#define ULOG_ARG(a) _Generic((a),                                                       \
+    char*: ulog_put_string, const char*: ulog_put_string,                               \
+    signed char*: ulog_put_string, const signed char*: ulog_put_string,                 \
+    unsigned char*: ulog_put_string, const unsigned char*: ulog_put_string,             \
+    void*: ulog_put_pointer, const void*: ulog_put_pointer,                             \
+    float: ulog_put_float, double: ulog_put_float,                                      \
+    default: ULOG_PUT_OTHER(a))((a), sizeof((a) + 0))
+
+// Any other pointer as %p, integers in full (int, long or long long)
+#define ULOG_PUT_OTHER(a)                                                               \
+    __builtin_choose_expr(__builtin_classify_type(a) == 5, ulog_put_pointer,            \
+    __builtin_choose_expr(sizeof((a) + 0) > 4, ulog_put_value64, ulog_put_value))
+
+// Up to 8 arguments, 9 to 16 fail at compile time
+#define ULOG_NARG(...) ULOG_NARG_(_, ##__VA_ARGS__,                                      \
+    TOO_MANY, TOO_MANY, TOO_MANY, TOO_MANY, TOO_MANY, TOO_MANY, TOO_MANY, TOO_MANY,     \
+    8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define ULOG_NARG_(_, a1, a2, a3, a4, a5, a6, a7, a8,                                   \
+    a9, a10, a11, a12, a13, a14, a15, a16, n, ...) n
+#define ULOG_CAT(a, b) ULOG_CAT_(a, b)
+#define ULOG_CAT_(a, b) a##b
+#define ULOG_ARGS(...) ULOG_CAT(ULOG_ARGS_, ULOG_NARG(__VA_ARGS__))(__VA_ARGS__)
+#define ULOG_ARGS_0()
+#define ULOG_ARGS_1(a) ULOG_ARG(a);
+#define ULOG_ARGS_2(a, ...) ULOG_ARG(a); ULOG_ARGS_1(__VA_ARGS__)
+#define ULOG_ARGS_3(a, ...) ULOG_ARG(a); ULOG_ARGS_2(__VA_ARGS__)
+#define ULOG_ARGS_4(a, ...) ULOG_ARG(a); ULOG_ARGS_3(__VA_ARGS__)
+#define ULOG_ARGS_5(a, ...) ULOG_ARG(a); ULOG_ARGS_4(__VA_ARGS__)
+#define ULOG_ARGS_6(a, ...) ULOG_ARG(a); ULOG_ARGS_5(__VA_ARGS__)
+#define ULOG_ARGS_7(a, ...) ULOG_ARG(a); ULOG_ARGS_6(__VA_ARGS__)
+#define ULOG_ARGS_8(a, ...) ULOG_ARG(a); ULOG_ARGS_7(__VA_ARGS__)
+#define ULOG_ARGS_TOO_MANY(...) _Static_assert(0, "ULOG takes at most 8 arguments");
+
+void ulog_put_id(uint16_t id);
+void ulog_put_value(uint32_t value, uint8_t size);
+void ulog_put_value64(uint64_t value, uint8_t size);
+void ulog_put_float(float value, uint8_t size);
+void ulog_put_pointer(const void* ptr, uint8_t size);
+void ulog_put_string(const void* str, uint8_t size);
+
+#else
+#define ULOG(fmt, ...) do {} while (0)
+#endif